@@ -0,0 +1,50 @@
+﻿#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <iostream>
+#include "tsp_solver.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Пиковый объем резидентной памяти процесса в килобайтах за все время его работы
+inline long long peakRssKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // На macOS значение в байтах
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Случайные точки в квадрате 1000 x 1000, воспроизводимые по зерну
+inline TspInstance randomEuclideanInstance(int size, std::uint64_t seed)
+{
+    Random random(seed);
+    std::vector<double> x(size);
+    std::vector<double> y(size);
+    for (int i = 0; i < size; ++i)
+    {
+        x[i] = random.uniform() * 1000.0;
+        y[i] = random.uniform() * 1000.0;
+    }
+    return TspInstance(std::make_shared<CoordinateDistances>(std::move(x), std::move(y), DistanceMetric::Euc2D));
+}
+
+#endif
@@ -0,0 +1,156 @@
+﻿// Микробенчмарки горячих функций солверов. Каждая функция вызывается в цикле,
+// число повторов подбирается так, чтобы замер длился не меньше ~0.2 с.
+// Использование: micro_bench [N] (по умолчанию N = 1000 городов)
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+#include "BenchUtils.h"
+
+namespace {
+
+volatile double sink; // Не дает компилятору выбросить результат
+
+// Среднее время одного вызова body() в наносекундах
+template <typename Body>
+double measure(Body body)
+{
+    long long repetitions = 1;
+    for (;;)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (long long r = 0; r < repetitions; ++r)
+            body();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (elapsed >= 2e8 || repetitions >= (1LL << 40))
+            return elapsed / repetitions;
+        repetitions *= elapsed < 2e7 ? 10 : 2;
+    }
+}
+
+void report(const std::string& name, double nanoseconds)
+{
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << nanoseconds << " ns/op\n";
+}
+
+}
+
+// Доступ к закрытым методам солверов (объявлен другом в GeneticAlgorithm, AntColony и SimulatedAnnealing)
+class MicroBenchmark {
+public:
+    explicit MicroBenchmark(int size):
+        instance(randomEuclideanInstance(size, 7)),
+        matrix(std::make_shared<DistanceMatrix>(denseMatrix(instance))),
+        candidates(std::make_shared<CandidateLists>(instance, 10)),
+        tour(size)
+    {
+        for (int i = 0; i < size; ++i)
+            tour[i] = i;
+        Random random(1);
+        std::shuffle(tour.begin(), tour.end(), random);
+    }
+
+    void run()
+    {
+        GeneticAlgorithm ga(matrix);
+        SimulatedAnnealing sa(matrix);
+        double gaLength = measure([&] { sink = ga.calculatePathLength(tour); });
+        double saLength = measure([&] { sink = sa.calculatePathLength(tour); });
+        GeneticAlgorithm gaCoordinates(instance);
+        double coordinateLength = measure([&] { sink = gaCoordinates.calculatePathLength(tour); });
+
+        double crossover = benchCrossover(ga);
+        double neighbor = benchNeighbor(sa, nullptr);
+        double candidateNeighbor = benchNeighbor(sa, candidates);
+        double construct = benchConstruct(nullptr);
+        double candidateConstruct = benchConstruct(candidates);
+
+        int n = instance.size();
+        report("calculatePathLength (matrix, N=" + std::to_string(n) + ")", gaLength);
+        report("calculatePathLength (SA, matrix)", saLength);
+        report("calculatePathLength (coordinates)", coordinateLength);
+        report("GeneticAlgorithm::crossoverHelper", crossover);
+        report("SimulatedAnnealing::getNeighbor + delta", neighbor);
+        report("SimulatedAnnealing::getNeighbor + delta (k=10)", candidateNeighbor);
+        report("AntColony::constructSolution", construct);
+        report("AntColony::constructSolution (k=10)", candidateConstruct);
+    }
+
+private:
+    TspInstance instance;
+    std::shared_ptr<DistanceMatrix> matrix;
+    std::shared_ptr<const CandidateLists> candidates;
+    std::vector<int> tour;
+
+    static std::vector<std::vector<double>> denseMatrix(const TspInstance& instance)
+    {
+        int n = instance.size();
+        std::vector<std::vector<double>> result(n, std::vector<double>(n));
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                result[i][j] = instance(i, j);
+        return result;
+    }
+
+    double benchCrossover(GeneticAlgorithm& ga)
+    {
+        const int n = instance.size();
+        std::vector<std::uint16_t> parent1(tour.begin(), tour.end());
+        std::vector<std::uint16_t> parent2(parent1.rbegin(), parent1.rend());
+        std::vector<std::uint16_t> child(n);
+        GeneticAlgorithm::Workspace workspace;
+        workspace.random.reseed(3);
+        workspace.mark.assign(n, 0);
+        return measure([&] {
+            int point1 = workspace.random.below(n);
+            int point2 = workspace.random.below(n);
+            if (point1 > point2)
+                std::swap(point1, point2);
+            ga.crossoverHelper(parent1.data(), parent2.data(), point1, point2, child.data(), workspace);
+            sink = child[0];
+        });
+    }
+
+    double benchNeighbor(SimulatedAnnealing& sa, std::shared_ptr<const CandidateLists> lists)
+    {
+        sa.setCandidateLists(lists);
+        SimulatedAnnealing::Chain chain;
+        chain.random.reseed(5);
+        sa.initializeChain(chain);
+        chain.path = tour;
+        for (size_t k = 0; k < tour.size() && lists; ++k)
+            chain.position[tour[k]] = static_cast<int>(k);
+        return measure([&] {
+            SimulatedAnnealing::Move move = sa.getNeighbor(chain);
+            sink = sa.getMoveDelta(chain.path, move);
+        });
+    }
+
+    double benchConstruct(std::shared_ptr<const CandidateLists> lists)
+    {
+        AntColony aco(matrix);
+        aco.setCandidateLists(lists);
+        aco.initializeHeuristic();
+        AntColony::AntWorkspace workspace;
+        workspace.random.reseed(9);
+        std::vector<int> path;
+        return measure([&] {
+            aco.constructSolution(workspace, path);
+            sink = path[1];
+        });
+    }
+};
+
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 1000;
+    if (size < 4 || size >= 65536)
+    {
+        std::cerr << "usage: micro_bench [N], 4 <= N < 65536\n";
+        return 2;
+    }
+    MicroBenchmark(size).run();
+    return 0;
+}
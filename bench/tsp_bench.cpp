@@ -0,0 +1,232 @@
+﻿// Сравнение солверов на наборе задач TSPLIB с известными оптимумами.
+// Использование: tsp_bench [--data DIR] [--seeds N] [--threads N] [--solvers ga,sa,aco,lk] [--format csv|json]
+// Файлы задач (<имя>.tsp) ищутся в каталоге DIR; отсутствующие задачи пропускаются.
+// Дополнительно всегда запускается синтетическая задача random200 (оптимум неизвестен).
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "BenchUtils.h"
+
+#ifndef TSP_BENCH_DATA_DIR
+#define TSP_BENCH_DATA_DIR "bench/data"
+#endif
+
+namespace {
+
+struct BenchInstance {
+    std::string name;
+    double optimum; // 0 - оптимум неизвестен
+};
+
+// Задачи TSPLIB и длины их оптимальных маршрутов
+const BenchInstance kInstances[] = {
+    { "berlin52", 7542 },
+    { "kroA100", 21282 },
+    { "ch150", 6528 },
+    { "a280", 2579 },
+    { "pr1002", 259045 },
+};
+
+struct Options {
+    std::string dataDir = TSP_BENCH_DATA_DIR;
+    int seeds = 3;
+    int threads = 1;
+    std::string solvers = "ga,sa,aco,lk";
+    std::string format = "csv";
+};
+
+struct Result {
+    std::string instance;
+    std::string solver;
+    std::uint64_t seed;
+    int size;
+    double length;
+    double optimum;
+    double wallMs;
+    long long evaluations;
+};
+
+struct RunOutput {
+    std::vector<int> tour;
+    double length;
+    long long evaluations;
+};
+
+RunOutput runSolver(const std::string& solver, const TspInstance& instance,
+                    const std::shared_ptr<const CandidateLists>& candidates, std::uint64_t seed, int threads)
+{
+    if (solver == "ga")
+    {
+        GeneticAlgorithm ga(instance, 200, 500);
+        ga.setSeed(seed);
+        ga.setThreads(threads);
+        std::vector<int> tour = ga.solve();
+        return { tour, ga.calculatePathLength(tour), ga.getEvaluations() };
+    }
+    if (solver == "sa")
+    {
+        SimulatedAnnealing sa(instance, 100, 0.99999, 1000000);
+        sa.setSeed(seed);
+        sa.setCandidateLists(candidates);
+        std::vector<int> tour = sa.solve();
+        return { tour, sa.calculatePathLength(tour), sa.getEvaluations() };
+    }
+    if (solver == "lk")
+    {
+        LinKernighan lk(instance, 1000);
+        lk.setSeed(seed);
+        lk.setCandidateLists(candidates);
+        std::vector<int> tour = lk.solve();
+        return { tour, lk.calculatePathLength(tour), lk.getEvaluations() };
+    }
+    AntColony aco(instance, 20, 50);
+    aco.setSeed(seed);
+    aco.setThreads(threads);
+    aco.setCandidateLists(candidates);
+    std::vector<int> tour = aco.solve();
+    return { tour, aco.calculatePathLength(tour), aco.getEvaluations() };
+}
+
+bool isPermutation(const std::vector<int>& tour, int size)
+{
+    if (static_cast<int>(tour.size()) != size)
+        return false;
+    std::vector<bool> seen(size, false);
+    for (int city : tour)
+    {
+        if (city < 0 || city >= size || seen[city])
+            return false;
+        seen[city] = true;
+    }
+    return true;
+}
+
+// peakRssKb - пик памяти всего процесса (ru_maxrss не убывает), поэтому он печатается один раз,
+// а не для каждого запуска
+void printResults(const std::vector<Result>& results, long long peakRssKb, const std::string& format)
+{
+    std::cout << std::fixed << std::setprecision(3);
+    if (format == "json")
+    {
+        std::cout << "{\"process_peak_rss_kb\": " << peakRssKb << ", \"runs\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& r = results[i];
+            double seconds = r.wallMs / 1000.0;
+            std::cout << "  {\"instance\": \"" << r.instance << "\", \"solver\": \"" << r.solver
+                      << "\", \"seed\": " << r.seed << ", \"n\": " << r.size << ", \"length\": " << r.length
+                      << ", \"optimum\": " << r.optimum << ", \"gap_percent\": "
+                      << (r.optimum > 0 ? 100.0 * (r.length - r.optimum) / r.optimum : 0.0)
+                      << ", \"wall_ms\": " << r.wallMs << ", \"evaluations\": " << r.evaluations
+                      << ", \"evals_per_sec\": " << (seconds > 0 ? r.evaluations / seconds : 0.0)
+                      << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        std::cout << "]}\n";
+        return;
+    }
+
+    std::cout << "instance,solver,seed,n,length,optimum,gap_percent,wall_ms,evaluations,evals_per_sec\n";
+    for (const Result& r : results)
+    {
+        double seconds = r.wallMs / 1000.0;
+        std::cout << r.instance << ',' << r.solver << ',' << r.seed << ',' << r.size << ',' << r.length << ',';
+        if (r.optimum > 0)
+            std::cout << r.optimum << ',' << 100.0 * (r.length - r.optimum) / r.optimum;
+        else
+            std::cout << ',';
+        std::cout << ',' << r.wallMs << ',' << r.evaluations << ','
+                  << (seconds > 0 ? r.evaluations / seconds : 0.0) << '\n';
+    }
+    std::cout << "# process_peak_rss_kb," << peakRssKb << '\n';
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+        if (arg == "--data")
+            options.dataDir = value;
+        else if (arg == "--seeds")
+            options.seeds = std::atoi(value.c_str());
+        else if (arg == "--threads")
+            options.threads = std::atoi(value.c_str());
+        else if (arg == "--solvers")
+            options.solvers = value;
+        else if (arg == "--format")
+            options.format = value;
+        else
+            return false;
+    }
+    return options.seeds > 0 && (options.format == "csv" || options.format == "json");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: tsp_bench [--data DIR] [--seeds N] [--threads N] [--solvers ga,sa,aco,lk] [--format csv|json]\n";
+        return 2;
+    }
+
+    std::vector<std::pair<BenchInstance, TspInstance>> instances;
+    for (const BenchInstance& bench : kInstances)
+    {
+        std::string path = options.dataDir + "/" + bench.name + ".tsp";
+        if (!std::ifstream(path))
+        {
+            std::cerr << "skip " << bench.name << ": " << path << " not found\n";
+            continue;
+        }
+        instances.emplace_back(bench, readTsplibFile(path).instance);
+    }
+    instances.emplace_back(BenchInstance{ "random200", 0 }, randomEuclideanInstance(200, 2024));
+
+    std::vector<std::string> solvers;
+    std::stringstream list(options.solvers);
+    for (std::string solver; std::getline(list, solver, ',');)
+    {
+        if (solver != "ga" && solver != "sa" && solver != "aco" && solver != "lk")
+        {
+            std::cerr << "unknown solver " << solver << "\n";
+            return 2;
+        }
+        solvers.push_back(solver);
+    }
+
+    std::vector<Result> results;
+    for (const auto& entry : instances)
+    {
+        auto candidates = std::make_shared<const CandidateLists>(entry.second, 10);
+        for (const std::string& solver : solvers)
+        {
+            for (std::uint64_t seed = 1; seed <= static_cast<std::uint64_t>(options.seeds); ++seed)
+            {
+                auto start = std::chrono::steady_clock::now();
+                RunOutput output = runSolver(solver, entry.second, candidates, seed, options.threads);
+                double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (!isPermutation(output.tour, entry.second.size()))
+                {
+                    std::cerr << "invalid tour: " << entry.first.name << " " << solver << " seed " << seed << "\n";
+                    return 1;
+                }
+                results.push_back({ entry.first.name, solver, seed, entry.second.size(), output.length,
+                                    entry.first.optimum, wallMs, output.evaluations });
+            }
+        }
+    }
+
+    printResults(results, peakRssKb(), options.format);
+    return 0;
+}
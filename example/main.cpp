@@ -3,6 +3,7 @@
 #include "GeneticAlgorithmTSP.h"
 #include "SimulatedAnnealing.h"
 #include "AntColony.h"
+#include "PortfolioSolver.h"
 
 // Генерация случайной симметричной матрицы
 std::vector<std::vector<double>> generateRandomDistanceMatrix(int size) {
@@ -25,26 +26,41 @@ std::vector<std::vector<double>> generateRandomDistanceMatrix(int size) {
 int main() 
 {
     setlocale(LC_ALL, "Russian");
-    srand(static_cast<unsigned>(time(0)));
 
-    std::vector<std::vector<double>> distanceMatrix = generateRandomDistanceMatrix(200);
+    // Одна матрица разделяется всеми солверами без копирования
+    auto distanceMatrix = std::make_shared<DistanceMatrix>(generateRandomDistanceMatrix(200));
+    // Ход решения печатается в консоль
+    auto observer = std::make_shared<ConsoleObserver>();
 
     std::cout << "Генетический алгоритм:\n";
     GeneticAlgorithm ga(distanceMatrix);
+    ga.setObserver(observer);
     std::vector<int> bestSolution = ga.solve();
     std::cout << "Лучший найденный путь: " << ga.calculatePathLength(bestSolution) << std::endl;
 
     std::cout << "\nАлгоритм имитации отжига:\n";
     SimulatedAnnealing sa(distanceMatrix);
+    sa.setObserver(observer);
     std::vector<int> bestPath = sa.solve();
     std::cout << "Лучший найденный путь: " << sa.calculatePathLength(bestPath) << std::endl;
 
     std::cout << "\nМуравьиный алгоритм:\n";
     AntColony aco(distanceMatrix);
+    aco.setObserver(observer);
     std::vector<int> bestPathACO = aco.solve();
 
 
     std::cout << "Лучший найденный путь: " << aco.calculatePathLength(bestPathACO) << std::endl;
 
+    // Те же солверы одновременно, с обменом лучшим маршрутом
+    std::cout << "\nПортфель солверов:\n";
+    std::vector<SolverConfig> configs(3);
+    configs[0].create = [](const TspInstance& t) { return std::unique_ptr<TspSolver>(new GeneticAlgorithm(t)); };
+    configs[1].create = [](const TspInstance& t) { return std::unique_ptr<TspSolver>(new SimulatedAnnealing(t)); };
+    configs[2].create = [](const TspInstance& t) { return std::unique_ptr<TspSolver>(new AntColony(t)); };
+    PortfolioSolver portfolio(distanceMatrix, configs);
+    std::vector<int> bestPathPortfolio = portfolio.solve();
+    std::cout << "Лучший найденный путь: " << portfolio.calculatePathLength(bestPathPortfolio) << std::endl;
+
     return 0;
 }
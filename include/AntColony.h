@@ -1,4 +1,4 @@
-#ifndef ANT_COLONY_OPTIMIZATION_H
+﻿#ifndef ANT_COLONY_OPTIMIZATION_H
 #define ANT_COLONY_OPTIMIZATION_H
 
 #include <vector>
@@ -7,20 +7,88 @@
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <random>
+#include <cstdint>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TspSolver.h"
+#include "LocalSearch.h"
+#include "KdTree.h"
 
-class AntColony {
+class AntColony : public TspSolver {
 public:
     AntColony(const std::vector<std::vector<double>>& distMatrix, int numAnts = 100, int maxIterations = 50, 
                           double alpha = 1.5, double beta = 1.5, double evaporationRate = 0.5, double q = 500);
-    std::vector<int> solve();
-    double calculatePathLength(const std::vector<int>& path);
+    AntColony(const TspInstance& distances, int numAnts = 100, int maxIterations = 50, 
+                          double alpha = 1.5, double beta = 1.5, double evaporationRate = 0.5, double q = 500);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setInstance(const TspInstance& instance, const std::vector<int>& previousIndex);
+    void resetPheromones();
+    void setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists) override;
+    void setLocalSearch(std::shared_ptr<const LocalSearch> localSearch);
+    void setMaxMin(bool enabled, double bestProbability = 0.05);
+    void setSparsePheromones(bool enabled);
+    void setSeed(std::uint64_t seed) override;
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    void setThreads(int threads);
+    long long getEvaluations() const override { return evaluations; } // Число построенных маршрутов за последний запуск
 
 private:
+    // Рабочие данные одного потока построения маршрутов
+    struct AntWorkspace {
+        Random random;
+        std::vector<double> unvisited;        // 1.0 для непосещенных городов, 0.0 для посещенных
+        std::vector<double> selectionWeights; // Веса рулетки на текущем шаге
+        LocalSearch::Workspace localSearch;
+        KdTree::Subset remaining;             // Непосещенные города для kd-дерева (разреженный режим)
+    };
+
     void updatePheromones(const std::vector<std::vector<int>>& allPaths, const std::vector<double>& allPathLengths);
-    std::vector<int> constructSolution();
+    void constructSolution(AntWorkspace& workspace, std::vector<int>& path);
+    void runBlocks(int blocks, const std::function<void(int)>& task);
+    double heuristicValue(int from, int to);
+    void allocatePheromones();
+    void initializeHeuristic();
+    void updateChoiceInfo();
+    void reportProgress(int iteration, const std::vector<double>& pathLengths, const double* phaseSeconds, bool finished);
+    int selectFromCandidates(AntWorkspace& workspace, int currentCity);
+    int selectFromAll(AntWorkspace& workspace, int currentCity);
+    int nearestUnvisited(AntWorkspace& workspace, int currentCity);
     void placePheromones(const std::vector<int>& path, double pathLength);
-    std::vector<std::vector<double>> distanceMatrix;
-    std::vector<std::vector<double>> pheromones;
+    void refreshChoiceInfo(const std::vector<int>& path);
+    void normalizePheromones();
+    bool updateBounds();
+    std::ptrdiff_t pheromoneIndex(int from, int to) const;
+    double pheromoneFloor() const { return maxMin ? minPheromone / pheromoneScale : 0.0; }
+    TspInstance distances;
+    std::shared_ptr<const CandidateLists> candidates; // Если заданы, муравей выбирает сначала среди них
+    std::shared_ptr<const LocalSearch> localSearch;   // Если задан, маршруты улучшаются до откладывания феромона
+    // Феромоны хранятся без общего множителя испарения: уровень ребра = pheromones * pheromoneScale.
+    // Испарение уменьшает только множитель, поэтому итерация меняет лишь ребра с отложенным феромоном
+    std::vector<double> pheromones;       // N * N по строкам или N * k по спискам кандидатов (sparsePheromones)
+    double pheromoneScale = 1.0;
+    bool freshPheromones = true;          // Феромоны на начальном уровне (для MAX-MIN - заполнить tau_max)
+    bool sparsePheromones = false;
+    bool maxMin = false;                  // Режим MAX-MIN: откладывает лучший муравей итерации, уровни ограничены
+    double bestProbability = 0.05;        // p_best в формуле нижней границы MAX-MIN
+    double minPheromone = 0.0;
+    double maxPheromone = std::numeric_limits<double>::infinity();
+    std::vector<double> coordinateX;      // Координаты для kd-дерева (разреженный режим, задача с координатами)
+    std::vector<double> coordinateY;
+    std::unique_ptr<KdTree> tree;
+    std::vector<double> heuristic;        // eta^beta, вычисляется один раз за запуск
+    std::vector<double> choiceInfo;       // tau^alpha * eta^beta, обновляется после updatePheromones
     std::vector<int> bestPath;
     double bestPathLength;
     int numAnts;
@@ -29,6 +97,14 @@ private:
     double beta;
     double evaporationRate;
     double q;
+    std::uint64_t seed;
+    int numThreads;
+    std::unique_ptr<ThreadPool> threadPool;
+    std::vector<AntWorkspace> workspaces;
+    long long evaluations = 0;
+    std::shared_ptr<SolverObserver> observer; // Если не задан, телеметрия не собирается
+
+    friend class MicroBenchmark;
 };
 
 #endif
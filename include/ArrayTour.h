@@ -0,0 +1,65 @@
+﻿#ifndef ARRAY_TOUR_H
+#define ARRAY_TOUR_H
+
+#include <vector>
+
+// Маршрут в виде массива городов с обратным индексом позиций. Соседи находятся за O(1),
+// 2-opt ход инвертирует более короткую из двух дуг. Направление обхода после хода
+// может смениться, поэтому ходы задаются ребрами, а не позициями
+class ArrayTour {
+public:
+    void assign(const std::vector<int>& cities);
+
+    const std::vector<int>& cities() const { return order; }
+    int size() const { return static_cast<int>(order.size()); }
+    int position(int city) const { return positions[city]; }
+    int cityAt(int index) const { return order[index]; }
+
+    int next(int city) const
+    {
+        int index = positions[city] + 1;
+        return order[index == size() ? 0 : index];
+    }
+
+    int prev(int city) const
+    {
+        int index = positions[city];
+        return order[index == 0 ? size() - 1 : index - 1];
+    }
+
+    // Лежит ли b на пути от a до c в прямом направлении (концы включаются)
+    bool between(int a, int b, int c) const;
+
+    // Замена ребер (a, b) и (c, d) на (a, c) и (b, d). Ребра должны быть направлены одинаково:
+    // b = next(a), d = next(c) либо b = prev(a), d = prev(c)
+    void twoOptMove(int a, int b, int c, int d);
+
+    // Участок из length1 городов, начинающийся с first, меняется местами со следующим
+    // за ним участком из length2 городов (ход double bridge)
+    void swapSegments(int first, int length1, int length2);
+
+private:
+    std::vector<int> order;     // Города в порядке обхода
+    std::vector<int> positions; // positions[order[i]] == i
+    std::vector<int> buffer;    // Временная копия участков в swapSegments
+
+    void reverse(int from, int to);
+};
+
+// Очередь активных городов для локального поиска ("don't-look bits"): город попадает
+// в очередь один раз, пока не будет из нее извлечен
+class ActiveQueue {
+public:
+    void reset(int numCities);
+    bool empty() const { return count == 0; }
+    void push(int city);
+    int pop();
+
+private:
+    std::vector<int> queue;   // Кольцевой буфер
+    std::vector<char> active; // Город находится в очереди (его don't-look bit снят)
+    int head = 0;
+    int count = 0;
+};
+
+#endif
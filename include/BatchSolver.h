@@ -0,0 +1,67 @@
+﻿#ifndef BATCH_SOLVER_H
+#define BATCH_SOLVER_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "TspInstance.h"
+#include "TspSolver.h"
+#include "StopPolicy.h"
+#include "ThreadPool.h"
+
+// Настройки солвера для пакетного решения
+struct SolverConfig {
+    // Создание солвера для первой задачи с этой конфигурацией; дальше объект переиспользуется
+    // через setInstance. Пример: [](const TspInstance& t) { return std::unique_ptr<TspSolver>(new AntColony(t, 20, 50)); }
+    // При переиспользовании сохраняются параметры конструктора и сеттеров алгоритма (setMaxMin,
+    // setReplicas, setThreads и т.п.) и наблюдатель, а списки кандидатов, локальный поиск,
+    // построение начального маршрута, маршруты теплого старта и обмен сбрасываются (см. TspSolver).
+    // Такие настройки задаются в configure, а не в create
+    std::function<std::unique_ptr<TspSolver>(const TspInstance&)> create;
+    // Необязательная настройка перед каждой задачей: вызывается после create или setInstance
+    // и построения списков кандидатов. Пример:
+    // [](TspSolver& s, const TspInstance& t) { static_cast<LinKernighan&>(s).setConstruction(std::make_shared<TourConstruction>(t)); }
+    std::function<void(TspSolver&, const TspInstance&)> configure;
+    int candidates = 0;   // Если больше 0, для каждой задачи строятся списки кандидатов такой длины
+    StopPolicy policy;
+};
+
+// Одна задача пакета
+struct BatchTask {
+    TspInstance instance;
+    int config = 0;          // Номер конфигурации в векторе SolverConfig
+    std::uint64_t seed = 0;
+};
+
+// Пакетное решение множества небольших задач. Каждая задача решается в одном потоке;
+// задачи распределяются по потокам непрерывными диапазонами, освободившийся поток забирает
+// половину оставшегося диапазона у другого (work stealing). У каждого потока свои объекты
+// солверов, поэтому их память переиспользуется от задачи к задаче и между вызовами solve.
+// Результаты возвращаются в порядке задач
+class BatchSolver {
+public:
+    BatchSolver(std::vector<SolverConfig> configs, int threads);
+
+    std::vector<SolveResult> solve(const std::vector<BatchTask>& tasks);
+
+private:
+    // Диапазон задач [begin, end) и солверы одного потока
+    struct Worker {
+        std::mutex mutex;
+        int begin = 0;
+        int end = 0;
+        std::vector<std::unique_ptr<TspSolver>> solvers; // По одному на конфигурацию
+    };
+
+    std::vector<SolverConfig> configs;
+    ThreadPool pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    bool takeTask(int worker, int& task);
+    bool stealTask(int worker, int& task);
+    SolveResult solveTask(Worker& worker, const BatchTask& task);
+};
+
+#endif
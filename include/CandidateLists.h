@@ -0,0 +1,30 @@
+﻿#ifndef CANDIDATE_LISTS_H
+#define CANDIDATE_LISTS_H
+
+#include <vector>
+#include "TspInstance.h"
+
+// Списки кандидатов: для каждого города - k ближайших соседей по возрастанию расстояния.
+// Хранятся одним массивом размера N * k. Если у задачи есть координаты, списки строятся
+// с помощью kd-дерева за O(N log N), иначе - частичной сортировкой строк матрицы
+class CandidateLists {
+public:
+    CandidateLists(const TspInstance& instance, int k = 10);
+
+    int size() const { return numCities; }
+    int count() const { return k; } // Число кандидатов у каждого города (не больше N - 1)
+
+    const int* begin(int city) const { return neighbors.data() + static_cast<std::size_t>(city) * k; }
+    const int* end(int city) const { return begin(city) + k; }
+    int get(int city, int rank) const { return neighbors[static_cast<std::size_t>(city) * k + rank]; }
+
+private:
+    int numCities;
+    int k;
+    std::vector<int> neighbors;
+
+    void buildFromCoordinates(const TspInstance& instance);
+    void buildFromMatrix(const TspInstance& instance);
+};
+
+#endif
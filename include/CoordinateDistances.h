@@ -0,0 +1,87 @@
+﻿#ifndef COORDINATE_DISTANCES_H
+#define COORDINATE_DISTANCES_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// Способ вычисления расстояния по координатам (соответствует EDGE_WEIGHT_TYPE в TSPLIB)
+enum class DistanceMetric {
+    Euclidean, // Точное евклидово расстояние без округления
+    Euc2D,     // EUC_2D: евклидово расстояние, округленное до ближайшего целого
+    Ceil2D,    // CEIL_2D: евклидово расстояние, округленное вверх
+    Geo,       // GEO: расстояние по поверхности Земли, координаты в формате DDD.MM
+    Att        // ATT: псевдоевклидово расстояние
+};
+
+// Неявная матрица расстояний: хранятся только координаты городов, расстояния
+// вычисляются по запросу. Память растет линейно по числу городов.
+// Для целочисленных метрик можно включить небольшой кэш на каждую строку:
+// cacheSlotsPerRow последних вычисленных расстояний для каждого города.
+class CoordinateDistances {
+public:
+    CoordinateDistances(std::vector<double> x, std::vector<double> y,
+                        DistanceMetric metric = DistanceMetric::Euclidean, int cacheSlotsPerRow = 0);
+
+    int size() const { return static_cast<int>(x.size()); }
+    DistanceMetric metric() const { return distanceMetric; }
+    int cacheSlotsPerRow() const { return cacheSlots; }
+    double getX(int i) const { return x[i]; }
+    double getY(int i) const { return y[i]; }
+    std::size_t memoryUsage() const;
+
+    double operator()(int i, int j) const
+    {
+        if (cacheSlots == 0)
+            return compute(i, j);
+        return cached(i, j);
+    }
+
+    // Вычисление расстояния без обращения к кэшу
+    double compute(int i, int j) const
+    {
+        if (i == j)
+            return 0.0;
+        switch (distanceMetric)
+        {
+        case DistanceMetric::Euclidean:
+            return euclidean(i, j);
+        case DistanceMetric::Euc2D:
+            return std::floor(euclidean(i, j) + 0.5);
+        case DistanceMetric::Ceil2D:
+            return std::ceil(euclidean(i, j));
+        case DistanceMetric::Geo:
+            return geo(i, j);
+        case DistanceMetric::Att:
+            return att(i, j);
+        }
+        return 0.0;
+    }
+
+private:
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> latitude;  // Для GEO: широта и долгота в радианах
+    std::vector<double> longitude;
+    DistanceMetric distanceMetric;
+
+    // Каждый слот кэша - одно 64-битное слово: (j + 1) в старших 32 битах, расстояние в младших.
+    // Слоты обновляются атомарно, поэтому кэш можно использовать из нескольких потоков
+    int cacheSlots;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> cache;
+
+    double euclidean(int i, int j) const
+    {
+        double dx = x[i] - x[j];
+        double dy = y[i] - y[j];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    double geo(int i, int j) const;
+    double att(int i, int j) const;
+    double cached(int i, int j) const;
+};
+
+#endif
@@ -0,0 +1,66 @@
+﻿#ifndef DECOMPOSITION_SOLVER_H
+#define DECOMPOSITION_SOLVER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "TspInstance.h"
+#include "TspSolver.h"
+#include "BatchSolver.h"
+#include "LocalSearch.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+// Способ разбиения задачи на кластеры
+enum class PartitionMethod {
+    KMeans,  // k-средних по координатам; слишком большие кластеры делятся пополам
+    Grid,    // Рекурсивное деление пополам по медиане вдоль более длинной стороны
+    Medoids  // k-медоид по расстояниям; для задач без координат используется всегда
+};
+
+// Решение больших задач декомпозицией. Города делятся на кластеры не больше clusterSize,
+// кластеры решаются параллельно солвером из SolverConfig (через BatchSolver), порядок обхода
+// кластеров задается маленькой задачей над их представителями (решается LinKernighan),
+// маршруты кластеров разрезаются в самых выгодных местах и склеиваются, затем 2-opt и Or-opt
+// исправляют маршрут вокруг стыков и границ кластеров. Время и память растут почти линейно по N.
+// Из StopPolicy в кластеры передаются срок и отмена; маршруты теплого старта не используются.
+// Солвер кластеров переиспользуется через setInstance, поэтому локальный поиск и построение
+// начального маршрута для него задаются в SolverConfig::configure
+class DecompositionSolver : public TspSolver {
+public:
+    DecompositionSolver(const TspInstance& distances, SolverConfig cluster, int clusterSize = 1000, int threads = 1);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists) override;
+    void setSeed(std::uint64_t seed) override;
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    void setPartition(PartitionMethod method);
+    void setRepair(bool enabled);
+    long long getEvaluations() const override { return evaluations; } // Сумма по кластерам за последний запуск
+
+private:
+    TspInstance distances;
+    SolverConfig clusterConfig;
+    int clusterSize;         // Наибольшее число городов в кластере
+    int threads;
+    PartitionMethod partition;
+    bool repair;             // Локальный поиск по границам после склейки
+    std::uint64_t seed;
+    std::shared_ptr<const CandidateLists> candidates; // Для исправления границ; если не заданы, строятся в solve (8 соседей)
+    std::shared_ptr<SolverObserver> observer;
+    long long evaluations = 0;
+    ThreadPool pool;         // Для разбиения; кластеры решает BatchSolver со своими потоками
+
+    std::vector<std::vector<int>> partitionCities(Random& random);
+    void kMeans(Random& random, std::vector<std::vector<int>>& clusters);
+    void kMedoids(Random& random, std::vector<std::vector<int>>& clusters);
+    void splitCluster(std::vector<int>& cities, int begin, int end, std::vector<std::vector<int>>& clusters) const;
+    int representative(const std::vector<int>& cluster) const;
+    TspInstance subInstance(const std::vector<int>& cities) const;
+    std::vector<int> stitch(const std::vector<std::vector<int>>& tours, const std::vector<int>& order,
+                            const std::vector<int>& representatives, std::vector<int>& junctions) const;
+};
+
+#endif
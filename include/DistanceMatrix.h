@@ -0,0 +1,82 @@
+﻿#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <string>
+
+// Матрица расстояний, хранящаяся одним непрерывным выровненным буфером (по строкам).
+// Поддерживает хранение в float32 и int32 и упакованное хранение верхнего треугольника
+// для симметричных задач. Солверы разделяют один экземпляр через std::shared_ptr без копирования.
+// Буфер может быть и отображенным в память файлом (см. MatrixFile.h) - тогда матрица только для чтения.
+// Копирование запрещено: копия разделяла бы буфер с оригиналом
+class DistanceMatrix {
+public:
+    enum class Precision { Double, Float, Int32 }; // Int32: целые расстояния, при записи округляются
+    enum class Layout { Full, UpperTriangular };
+
+    explicit DistanceMatrix(int size, Precision precision = Precision::Double, Layout layout = Layout::Full);
+    explicit DistanceMatrix(const std::vector<std::vector<double>>& matrix,
+                            Precision precision = Precision::Double, Layout layout = Layout::Full);
+    DistanceMatrix(const DistanceMatrix&) = delete;
+    DistanceMatrix& operator=(const DistanceMatrix&) = delete;
+
+    int size() const { return n; }
+    Precision precision() const { return valuePrecision; }
+    Layout layout() const { return valueLayout; }
+    std::size_t memoryUsage() const { return count * elementSize(); }
+
+    double operator()(int i, int j) const
+    {
+        if (valueLayout == Layout::UpperTriangular)
+        {
+            if (i == j)
+                return 0.0;
+            if (i > j)
+                std::swap(i, j);
+        }
+        std::size_t k = index(i, j);
+        if (valuePrecision == Precision::Double)
+            return static_cast<const double*>(data)[k];
+        if (valuePrecision == Precision::Float)
+            return static_cast<const float*>(data)[k];
+        return static_cast<const std::int32_t*>(data)[k];
+    }
+
+    void set(int i, int j, double value);
+
+    // Преобразование обратно в вектор векторов (для совместимости со старым кодом)
+    std::vector<std::vector<double>> toVector() const;
+
+    // Хранимые элементы одним буфером: по строкам, для UpperTriangular - строгий верхний треугольник
+    const void* rawData() const { return data; }
+    std::size_t elementCount() const { return count; }
+    std::size_t elementSize() const { return valuePrecision == Precision::Double ? sizeof(double) : 4; }
+
+private:
+    int n;
+    Precision valuePrecision;
+    Layout valueLayout;
+    std::size_t count;           // Количество хранимых элементов
+    std::shared_ptr<void> storage;
+    void* data;
+
+    // Матрица поверх готового буфера (отображенного файла), владение буфером - через storage
+    DistanceMatrix(int size, Precision precision, Layout layout, std::shared_ptr<void> storage, void* data);
+    friend std::shared_ptr<const DistanceMatrix> mapMatrixFile(const std::string& path, bool verify);
+
+    std::size_t index(int i, int j) const
+    {
+        if (valueLayout == Layout::Full)
+            return static_cast<std::size_t>(i) * n + j;
+        // Строго верхний треугольник, i < j
+        return static_cast<std::size_t>(i) * (2 * static_cast<std::size_t>(n) - i - 1) / 2 + (j - i - 1);
+    }
+
+    void allocate();
+};
+
+#endif
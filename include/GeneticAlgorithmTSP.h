@@ -7,16 +7,45 @@
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
-#include <unordered_map>
-#include <unordered_set>
 #include <random>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include "TspInstance.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TspSolver.h"
+#include "LocalSearch.h"
+#include "TourConstruction.h"
 
-class GeneticAlgorithm {
+class GeneticAlgorithm : public TspSolver {
 public:
+    // Схема обмена особями между островами
+    enum class MigrationTopology {
+        Ring,  // Остров i отправляет мигрантов на остров i + 1
+        Random // Остров-получатель выбирается случайно
+    };
+
     GeneticAlgorithm(const std::vector<std::vector<double>>& distanceMatrix, int populationSize = 500, 
                      int generations = 1000, double mutationRate = 0.2, double crossoverRate = 0.95, int tournamentSize = 7);
-    std::vector<int> solve();
-    double calculatePathLength(const std::vector<int>& path);
+    GeneticAlgorithm(const TspInstance& distances, int populationSize = 500, 
+                     int generations = 1000, double mutationRate = 0.2, double crossoverRate = 0.95, int tournamentSize = 7);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setSeed(std::uint64_t seed) override;
+    void setThreads(int threads);
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    long long getEvaluations() const override { return evaluations.load(); } // Число оценок маршрутов за последний запуск
+    void setLocalSearch(std::shared_ptr<const LocalSearch> localSearch, double rate = 1.0);
+    void setConstruction(std::shared_ptr<const TourConstruction> construction, double rate = 1.0);
+    void setIslands(int islands, int migrationInterval = 50, int migrants = 2,
+                    MigrationTopology topology = MigrationTopology::Ring);
 
 private:
     int numCities;               // Количество городов
@@ -26,22 +55,93 @@ private:
     double crossoverRate;        // Вероятность скрещивания
     int tournamentSize;          // Размер турнира
 
-    std::vector<std::vector<double>> distanceMatrix; // Матрица расстояний
+    TspInstance distances;       // Расстояния между городами (общие, без копирования)
+
+    std::uint64_t seed;          // Зерно генератора случайных чисел
+    int numThreads;              // Число потоков при построении поколения
+    std::unique_ptr<ThreadPool> threadPool;
+    std::atomic<long long> evaluations{ 0 };
+    std::shared_ptr<SolverObserver> observer; // Если не задан, телеметрия не собирается
+    std::shared_ptr<const LocalSearch> localSearch; // Меметический шаг: улучшение потомков локальным поиском
+    double localSearchRate;      // Доля потомков, к которым применяется локальный поиск
+    std::shared_ptr<const TourConstruction> construction; // Построение особей начальной популяции эвристикой
+    double constructionRate;     // Доля начальной популяции, построенная эвристикой
+
+    int numIslands;              // Число независимых популяций (1 - обычный режим)
+    int migrationInterval;       // Обмен особями каждые migrationInterval поколений
+    int numMigrants;             // Сколько лучших особей отправляется за один обмен
+    MigrationTopology topology;
+
+    // Популяция хранится одним массивом генов: маршрут особи i - genes[i * numCities ... (i + 1) * numCities).
+    // Gene - uint16_t, если городов меньше 65536, иначе uint32_t
+    template <typename Gene>
+    struct Population {
+        std::vector<Gene> genes;
+        std::vector<double> fitness; // Приспособленность (целевая функция), обратно пропорциональная длине маршрута
+
+        Gene* path(int index, int numCities) { return genes.data() + static_cast<size_t>(index) * numCities; }
+        const Gene* path(int index, int numCities) const { return genes.data() + static_cast<size_t>(index) * numCities; }
+    };
+
+    // Рабочие данные одного блока поколения
+    struct Workspace {
+        Random random;
+        std::vector<std::uint32_t> mark; // Метки городов сегмента в OX: mark[city] == stamp - город уже в потомке
+        std::uint32_t stamp = 0;
+        double phaseSeconds[kSolverPhaseCount] = {}; // Время фаз, накопленное этим блоком
+        LocalSearch::Workspace localSearch;
+        std::vector<int> tour;           // Маршрут особи в виде int для локального поиска
+    };
+    std::vector<Workspace> workspaces;
 
-    struct Individual {
-        std::vector<int> path;    // Путь обхода городов
-        double fitness;           // Приспособленность (целевая функция), обратно пропорциональная длине маршрута
+    // Почтовый ящик острова: последние присланные мигранты. Блокировка берется раз в
+    // migrationInterval поколений, получатель не ждет, если ящик занят
+    template <typename Gene>
+    struct Mailbox {
+        std::mutex mutex;
+        std::vector<Gene> genes;
+        std::vector<double> fitness;
+        bool fresh = false;
     };
 
-    std::vector<Individual> initializePopulation();
-    void evaluateFitness(std::vector<Individual>& population);
-    Individual bestIndividual(const std::vector<Individual>& population);
-    std::vector<Individual> selection(const std::vector<Individual>& population);
-    std::vector<Individual> crossover(const Individual& parent1, const Individual& parent2);
-    Individual crossoverHelper(const Individual& parent1, const Individual& parent2, int point1, int point2);
-    void mutate(Individual& indiv);
-    void printBestSolution(int generation, const Individual& best);
+    // Итог работы одного острова
+    template <typename Gene>
+    struct IslandState {
+        std::vector<Gene> best;
+        double bestFitness = 0.0;
+        int generations = 0;
+        StopReason reason = StopReason::None;
+    };
+
+    // Буферы популяций (текущая и следующая) сохраняются между запусками
+    Population<std::uint16_t> populations16[2];
+    Population<std::uint32_t> populations32[2];
+    template <typename Gene> Population<Gene>* populationBuffers();
+
+    template <typename Gene> SolveResult run(const StopCondition& stop);
+    template <typename Gene> SolveResult runIslands(const StopCondition& stop);
+    template <typename Gene> void evolveIsland(int island, std::vector<Mailbox<Gene>>& mailboxes, IslandState<Gene>& state,
+                                               const StopCondition& stop, std::atomic<StopReason>& globalStop);
+    template <typename Gene> void migrate(int island, Population<Gene>& population, std::vector<int>& order,
+                                          std::vector<Mailbox<Gene>>& mailboxes);
+    template <typename Gene> bool shareBest(Population<Gene>& population, std::vector<Gene>& best, double& bestFitness);
+    template <typename Gene> void initializePopulation(Population<Gene>& population, Workspace& workspace, int begin, int end);
+    template <typename Gene> double pathLength(const Gene* path) const;
+    template <typename Gene> int bestIndividual(const Population<Gene>& population) const;
+    template <typename Gene> int selection(const Population<Gene>& population, Random& random) const;
+    template <typename Gene> void crossover(const Gene* parent1, const Gene* parent2, Gene* child1, Gene* child2, Workspace& workspace);
+    template <typename Gene> void crossoverHelper(const Gene* parent1, const Gene* parent2, int point1, int point2,
+                                                  Gene* child, Workspace& workspace);
+    template <typename Gene> void mutate(Gene* path, Random& random);
+    template <typename Gene> void improve(Gene* path, Workspace& workspace);
+    template <typename Gene> void breed(const Population<Gene>& population, Population<Gene>& newPopulation,
+                                        Workspace& workspace, int pairBegin, int pairEnd);
+    template <typename Task> void runBlocks(int blocks, const Task& task);
+    template <typename Gene> void reportProgress(int generation, const Population<Gene>& population, int bestIndex,
+                                                 double bestFitness, int workspaceBegin, int workspaceEnd, bool finished);
+
+    friend class MicroBenchmark;
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,37 @@
+﻿#ifndef INSTANCE_EDITS_H
+#define INSTANCE_EDITS_H
+
+#include <vector>
+#include "TspInstance.h"
+
+// Новое расстояние между двумя городами (матрица остается симметричной)
+struct EdgeUpdate {
+    int from;
+    int to;
+    double weight;
+};
+
+// Результат правки задачи: новая задача и отображение ее городов на прежние.
+// previousIndex[i] - номер города i в прежней задаче или -1 для добавленного города. Перемещенный
+// moveCity город сохраняет свой номер, но тоже отмечается -1: его ребра изменились, поэтому
+// repairTour вставляет его заново в самое дешевое место, а AntColony не переносит его феромоны
+struct EditedInstance {
+    TspInstance instance;
+    std::vector<int> previousIndex;
+};
+
+// Небольшие правки задачи для повторного решения с теплого старта. Исходная задача
+// не меняется: строится новая с теми же точностью, раскладкой матрицы и метрикой.
+// Добавленный город получает последний номер. При ошибке бросается std::invalid_argument
+EditedInstance addCity(const TspInstance& instance, const std::vector<double>& distances); // Матрица: расстояния до всех городов
+EditedInstance addCity(const TspInstance& instance, double x, double y);                   // Координаты
+EditedInstance removeCity(const TspInstance& instance, int city);
+EditedInstance moveCity(const TspInstance& instance, int city, double x, double y);         // Только координаты
+EditedInstance updateEdges(const TspInstance& instance, const std::vector<EdgeUpdate>& updates); // Только матрица
+
+// Перенос маршрута прежней задачи на новую: удаленные города пропускаются, добавленные
+// вставляются по одному в самое дешевое место (O(N) на город). Результат подходит
+// для TspSolver::setInitialTours
+std::vector<int> repairTour(const EditedInstance& edited, const std::vector<int>& previousTour);
+
+#endif
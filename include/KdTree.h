@@ -0,0 +1,46 @@
+﻿#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include <vector>
+#include <utility>
+
+// Двумерное kd-дерево над координатами городов для поиска ближайших соседей.
+// Дерево хранит собственную копию координат, поэтому не зависит от времени жизни источника
+class KdTree {
+public:
+    KdTree(std::vector<double> xs, std::vector<double> ys);
+
+    // k ближайших к точке (qx, qy) городов, кроме exclude, в порядке возрастания евклидова расстояния
+    void nearest(double qx, double qy, int k, int exclude, std::vector<int>& result) const;
+
+    // Подмножество городов, меняющееся по ходу работы (например, еще не посещенные).
+    // count[m] - число городов подмножества в поддереве узла m. Хранится вне дерева,
+    // поэтому одно дерево можно использовать из нескольких потоков, каждый - со своим Subset
+    struct Subset {
+        std::vector<int> count;
+        std::vector<char> member;
+    };
+
+    void fillSubset(Subset& subset, bool all) const; // Все города либо пустое подмножество
+    void insert(Subset& subset, int city) const;
+    void erase(Subset& subset, int city) const;
+
+    // Ближайший к точке (qx, qy) город подмножества или -1, если оно пусто
+    int nearestIn(const Subset& subset, double qx, double qy) const;
+
+private:
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<int> order;          // Узел дерева - середина диапазона [lo, hi) этого массива
+    std::vector<unsigned char> axis; // Ось разбиения для каждого узла: 0 - x, 1 - y
+    std::vector<int> position;       // Позиция каждого города в order
+
+    void build(int lo, int hi);
+    void search(int lo, int hi, double qx, double qy, int k, int exclude,
+                std::vector<std::pair<double, int>>& heap) const;
+    int fillCounts(int lo, int hi, std::vector<int>& count) const;
+    void updateCounts(Subset& subset, int city, int delta) const;
+    void searchIn(int lo, int hi, const Subset& subset, double qx, double qy, double& bestDistance, int& best) const;
+};
+
+#endif
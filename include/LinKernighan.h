@@ -0,0 +1,74 @@
+﻿#ifndef LIN_KERNIGHAN_H
+#define LIN_KERNIGHAN_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "ArrayTour.h"
+#include "TwoLevelTour.h"
+#include "Random.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TspSolver.h"
+#include "TourConstruction.h"
+
+// Итерированный поиск Лина - Кернигана. Улучшающий ход - цепочка 2-opt обменов переменной
+// глубины (до maxDepth) по спискам кандидатов с критерием положительного частичного выигрыша;
+// на первом уровне перебираются до 5 лучших вариантов, на втором - до 3, дальше только лучший.
+// Перебор ограничен списками кандидатов и этой шириной, поэтому улучшающий ход, даже
+// последовательный 3-opt, может быть пропущен. После локального оптимума выполняется
+// kicks возмущений double bridge; результат возмущения принимается, только если маршрут стал короче.
+// Начиная с kTwoLevelTourMinCities городов маршрут хранится двухуровневым списком
+class LinKernighan : public TspSolver {
+public:
+    LinKernighan(const std::vector<std::vector<double>>& distanceMatrix, int kicks = 1000, int maxDepth = 50);
+    LinKernighan(const TspInstance& distances, int kicks = 1000, int maxDepth = 50);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists) override;
+    void setSeed(std::uint64_t seed) override;
+    void setConstruction(std::shared_ptr<const TourConstruction> construction);
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    long long getEvaluations() const override { return evaluations; } // Число проверенных шагов цепочек за последний запуск
+
+private:
+    TspInstance distances;
+    int kicks;               // Число возмущений после первого спуска
+    int maxDepth;            // Наибольшая глубина цепочки обменов
+    std::uint64_t seed;
+    Random random;
+    std::shared_ptr<const CandidateLists> candidates; // Если не заданы, строятся в solve (10 соседей)
+    std::shared_ptr<const TourConstruction> construction; // Если задано, первый спуск начинается с построенного маршрута
+    std::shared_ptr<SolverObserver> observer;
+    long long evaluations = 0;
+
+    // Выполненный 2-opt обмен: ребра (a, b), (c, d) заменены на (a, c), (b, d)
+    struct Flip {
+        int a;
+        int b;
+        int c;
+        int d;
+    };
+
+    ArrayTour arrayTour;
+    TwoLevelTour listTour;
+    ActiveQueue queue;
+    std::vector<Flip> flips;                    // Журнал обменов с последнего принятого состояния
+    std::vector<std::pair<int, int>> added;     // Ребра, добавленные текущей цепочкой
+    double bestGain = 0.0;                      // Лучший выигрыш текущей цепочки
+    std::size_t bestFlipCount = 0;              // Длина журнала в точке лучшего выигрыша
+
+    template <typename Tour> SolveResult run(Tour& tour, const StopCondition& stop);
+    template <typename Tour> double optimize(Tour& tour);
+    template <typename Tour> double improveCity(Tour& tour, int t1);
+    template <typename Tour> void step(Tour& tour, int level, int t1, int t2, double gain);
+    template <typename Tour> void applyFlip(Tour& tour, int a, int b, int c, int d);
+    template <typename Tour> void rollback(Tour& tour, std::size_t flipCount);
+    bool isAdded(int a, int b) const;
+};
+
+#endif
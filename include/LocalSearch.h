@@ -0,0 +1,49 @@
+﻿#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <vector>
+#include <memory>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "ArrayTour.h"
+#include "TwoLevelTour.h"
+
+// Локальный поиск 2-opt и Or-opt с первым улучшением. Ходы перебираются только среди
+// списков кандидатов, а "don't-look bits" (очередь активных городов) не дают повторно
+// проверять города, вокруг которых маршрут не менялся. Начиная с kTwoLevelTourMinCities
+// городов маршрут хранится двухуровневым списком. Объект не меняется в improve,
+// поэтому один экземпляр можно использовать из нескольких потоков, каждый - со своим Workspace
+class LocalSearch {
+public:
+    // Рабочие данные одного потока; память переиспользуется между вызовами
+    struct Workspace {
+        ArrayTour tour;
+        TwoLevelTour listTour; // Для больших задач
+        ActiveQueue queue;
+    };
+
+    LocalSearch(const TspInstance& distances, std::shared_ptr<const CandidateLists> candidates);
+
+    void setOrOpt(bool enabled, int maxSegment = 3);
+
+    // Улучшает маршрут на месте до локального оптимума, возвращает изменение длины (<= 0)
+    double improve(std::vector<int>& tour, Workspace& workspace) const;
+
+    // То же, но вначале активны только города active (например, стыки склеенных участков)
+    double improve(std::vector<int>& tour, const std::vector<int>& active, Workspace& workspace) const;
+
+private:
+    TspInstance distances;
+    std::shared_ptr<const CandidateLists> candidates;
+    bool orOpt;
+    int maxSegment; // Наибольшая длина переносимого Or-opt участка
+
+    template <typename Tour>
+    double descend(Tour& tour, ActiveQueue& queue) const;
+    template <typename Tour>
+    double improveTwoOpt(Tour& tour, ActiveQueue& queue, int a) const;
+    template <typename Tour>
+    double improveOrOpt(Tour& tour, ActiveQueue& queue, int a) const;
+};
+
+#endif
@@ -0,0 +1,50 @@
+﻿#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include <string>
+#include <istream>
+#include <memory>
+#include <cstdint>
+#include "DistanceMatrix.h"
+
+// Двоичный формат матрицы расстояний для загрузки без разбора и копирования.
+// Заголовок - 64 байта, числа в порядке байтов записавшей машины (на x86 и ARM - little-endian;
+// чужой порядок обнаруживается по метке):
+//   0  char[8]  магия "TSPMATRX"
+//   8  uint32   версия формата (1)
+//  12  uint32   метка порядка байтов 0x01020304
+//  16  uint64   число городов N
+//  24  uint32   тип значений: 0 - float64, 1 - float32, 2 - int32
+//  28  uint32   1 - симметричная матрица (хранится строгий верхний треугольник), 0 - полная
+//  32  uint64   размер данных в байтах
+//  40  uint64   контрольная сумма данных (FNV-1a по 64-битным словам, хвост дополнен нулями)
+//  48  16 байт  зарезервировано (нули)
+// Данные начинаются со смещения 64 и идут по строкам, как в DistanceMatrix.
+struct MatrixFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t size;
+    std::uint32_t valueType;
+    std::uint32_t symmetric;
+    std::uint64_t dataBytes;
+    std::uint64_t checksum;
+    std::uint8_t reserved[16];
+};
+
+// Запись матрицы в двоичный файл; тип значений и раскладка берутся из матрицы
+void writeMatrixFile(const std::string& path, const DistanceMatrix& matrix);
+
+// Потоковое преобразование текстовой матрицы (N, затем N * N чисел по строкам) в двоичный файл.
+// В памяти держится одна строка, поэтому подходит для матриц, не помещающихся в память.
+// Для UpperTriangular записывается только верхний треугольник (матрица считается симметричной)
+void convertTextMatrix(std::istream& input, const std::string& path,
+                       DistanceMatrix::Precision precision = DistanceMatrix::Precision::Float,
+                       DistanceMatrix::Layout layout = DistanceMatrix::Layout::UpperTriangular);
+
+// Отображение файла в память только для чтения: страницы подгружаются операционной системой
+// по мере обращения и разделяются между процессами. Файл остается отображенным, пока жива матрица.
+// verify - проверить контрольную сумму (читает весь файл). При ошибке бросается std::runtime_error
+std::shared_ptr<const DistanceMatrix> mapMatrixFile(const std::string& path, bool verify = false);
+
+#endif
@@ -0,0 +1,49 @@
+﻿#ifndef PORTFOLIO_SOLVER_H
+#define PORTFOLIO_SOLVER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "TspInstance.h"
+#include "TspSolver.h"
+#include "BatchSolver.h"
+#include "TourExchange.h"
+#include "Random.h"
+#include "ThreadPool.h"
+
+// Портфель солверов: несколько настроенных солверов одновременно решают одну задачу, каждый
+// в своем потоке, над общим экземпляром задачи только для чтения. Улучшения публикуются в общий
+// TourExchange; при shareTours солверы подхватывают общий лучший маршрут. Все солверы
+// останавливаются по общему сроку, по отмене или как только общий маршрут достиг targetLength.
+// Результат - лучший из маршрутов солверов; наблюдатель передается всем солверам
+// (он должен допускать вызовы из нескольких потоков, как ConsoleObserver; у SolverCounters
+// при этом осмысленны только starts, bestLength и improvements)
+class PortfolioSolver : public TspSolver {
+public:
+    PortfolioSolver(const TspInstance& distances, std::vector<SolverConfig> configs, bool shareTours = true);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists) override;
+    void setSeed(std::uint64_t seed) override;
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    long long getEvaluations() const override { return evaluations; } // Сумма по солверам за последний запуск
+
+    // Результаты каждого солвера за последний запуск, в порядке конфигураций
+    const std::vector<SolveResult>& lastResults() const { return results; }
+
+private:
+    TspInstance distances;
+    std::vector<SolverConfig> configs;
+    bool shareTours;
+    std::uint64_t seed;
+    std::shared_ptr<const CandidateLists> candidates; // Если заданы, используются всеми солверами
+    std::shared_ptr<SolverObserver> observer;
+    long long evaluations = 0;
+    std::vector<std::unique_ptr<TspSolver>> solvers; // Создаются при первом solve, дальше переиспользуются
+    std::vector<SolveResult> results;
+    ThreadPool pool;                                 // По потоку на солвер и поток наблюдения за остановкой
+};
+
+#endif
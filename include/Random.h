@@ -0,0 +1,102 @@
+﻿#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// Быстрый генератор xoshiro256** (период 2^256 - 1, состояние 32 байта).
+// Удовлетворяет требованиям UniformRandomBitGenerator, поэтому подходит для std::shuffle
+// и распределений <random>. jump() продвигает состояние на 2^128 шагов - так из одного
+// зерна получаются непересекающиеся потоки для параллельных вычислений
+class Random {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Random(std::uint64_t seed = 0) { reseed(seed); }
+
+    // Инициализация состояния через splitmix64, как рекомендуют авторы xoshiro
+    void reseed(std::uint64_t seed)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Равномерное число в [0, 1)
+    double uniform() { return ((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Равномерное целое в [0, bound) без заметного смещения (метод Лемира)
+    int below(int bound)
+    {
+        std::uint64_t x = (*this)() >> 32;
+        return static_cast<int>((x * static_cast<std::uint64_t>(bound)) >> 32);
+    }
+
+    // Равномерное целое в [low, high]
+    int between(int low, int high) { return low + below(high - low + 1); }
+
+    void jump()
+    {
+        static const std::uint64_t kJump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                               0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        std::uint64_t s[4] = { 0, 0, 0, 0 };
+        for (std::uint64_t word : kJump)
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                if (word & (1ULL << b))
+                {
+                    for (int i = 0; i < 4; ++i)
+                        s[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; ++i)
+            state[i] = s[i];
+    }
+
+    // Случайное зерно для солверов, которым не задали его явно
+    static std::uint64_t randomSeed()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    }
+
+    // Новый независимый поток: копия текущего состояния, а сам генератор сдвигается на 2^128 шагов
+    Random split()
+    {
+        Random stream = *this;
+        jump();
+        return stream;
+    }
+
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+#endif
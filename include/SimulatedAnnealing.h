@@ -6,23 +6,102 @@
 #include <algorithm>
 #include <random>
 #include <iostream>
+#include <memory>
+#include <cstdint>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "Random.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TspSolver.h"
+#include "TourConstruction.h"
+#include "TwoLevelTour.h"
+#include "ThreadPool.h"
 
-class SimulatedAnnealing {
+class SimulatedAnnealing : public TspSolver {
 public:
     SimulatedAnnealing(const std::vector<std::vector<double>>& distanceMatrix, double initialTemp = 10000, 
                        double coolingRate = 0.9999, int iterations = 300000);
-    std::vector<int> solve();
-    double calculatePathLength(const std::vector<int>& path);
+    SimulatedAnnealing(const TspInstance& distances, double initialTemp = 10000, 
+                       double coolingRate = 0.9999, int iterations = 300000);
+    std::vector<int> solve() override;
+    SolveResult solve(const StopPolicy& policy) override;
+    double calculatePathLength(const std::vector<int>& path) override;
+    void setInstance(const TspInstance& instance) override;
+    void setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists) override;
+    void setSeed(std::uint64_t seed) override;
+    void setConstruction(std::shared_ptr<const TourConstruction> construction);
+    void setReplicas(int replicas, int swapInterval = 1000, double temperatureRatio = 5.0);
+    void setObserver(std::shared_ptr<SolverObserver> observer) override;
+    long long getEvaluations() const override { return evaluations; } // Число оцененных ходов за последний запуск
+
+    // 2-opt ход: инверсия участка маршрута path[i..j], 1 <= i <= j < path.size()
+    struct Move {
+        int i;
+        int j;
+    };
 
 private:
-    const std::vector<std::vector<double>>& distanceMatrix;
+    TspInstance distances;
     double initialTemp;
     double coolingRate;
     int iterations;
+    std::uint64_t seed;      // Зерно генератора: одинаковое зерно дает одинаковый запуск
+    std::shared_ptr<const CandidateLists> candidates; // Если заданы, ход соединяет город с одним из его кандидатов
+    std::shared_ptr<const TourConstruction> construction; // Если задано, начальное решение строится эвристикой
+    long long evaluations = 0;
+    std::shared_ptr<SolverObserver> observer; // Если не задан, телеметрия не собирается
+
+    int numReplicas;         // Число реплик параллельного отжига (1 - обычный отжиг)
+    int swapInterval;        // Обмен состояниями между соседними температурами каждые swapInterval итераций
+    double replicaTemperatureRatio; // Отношение температур самой горячей и самой холодной реплик
+    std::unique_ptr<ThreadPool> threadPool;
+
+    // 2-opt ход по городам для двухуровневого списка: ребра (a, b), (c, d) заменяются на (a, c), (b, d)
+    struct ListMove {
+        int a;
+        int b;
+        int c;
+        int d;
+    };
 
-    std::vector<int> generateInitialSolution();
-    std::vector<int> getNeighbor(const std::vector<int>& currentPath);
+    // Цепочка отжига: текущее решение, лучшее решение цепочки и свой генератор.
+    // В больших задачах со списками кандидатов текущее решение хранится в listTour, а не в path
+    struct Chain {
+        Random random;
+        std::vector<int> path;
+        std::vector<int> position; // Позиция каждого города в path (только при списках кандидатов)
+        bool onList = false;       // Текущее решение в listTour
+        TwoLevelTour listTour;
+        double distance = 0.0;
+        std::vector<int> best;
+        double bestDistance = 0.0;
+        bool currentIsBest = true; // Текущее решение совпадает с лучшим, но еще не скопировано в best
+        bool bestInJournal = false;      // Лучшее решение получается отменой ходов sinceBest (только listTour)
+        std::vector<ListMove> sinceBest; // Ходы, принятые после ухода из лучшего решения
+        long long accepted = 0;    // Принятые ходы с прошлого отчета
+        long long evaluations = 0;
+        long long lastImprovement = 0; // Итерация последнего улучшения лучшего решения
+    };
+
+    std::vector<Chain> chains; // Цепочки сохраняются между запусками, чтобы не выделять память заново
+
+    void initializeChain(Chain& chain, int index = 0);
+    void loadPath(Chain& chain);
+    void shareBest(Chain& chain, long long iteration);
+    void annealStep(Chain& chain, double temperature, long long iteration);
+    const std::vector<int>& bestPath(Chain& chain) const;
+    SolveResult solveReplicas(const StopCondition& stop);
+    Move getNeighbor(Chain& chain);
+    double getMoveDelta(const std::vector<int>& path, const Move& move) const;
+    void applyMove(Chain& chain, const Move& move);
+    ListMove getListNeighbor(Chain& chain) const;
+    double getListMoveDelta(const ListMove& move) const;
+    void applyListMove(Chain& chain, const ListMove& move);
+    void saveBest(Chain& chain) const;
     double getAcceptanceProbability(double currentDistance, double newDistance, double temperature);
+
+    friend class MicroBenchmark;
 };
 
 #endif
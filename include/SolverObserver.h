@@ -0,0 +1,123 @@
+﻿#ifndef SOLVER_OBSERVER_H
+#define SOLVER_OBSERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+
+// Фазы работы солверов, для которых накапливается время
+enum class SolverPhase {
+    Initialization,  // Начальная популяция / начальное решение / таблицы ACO
+    Selection,       // GA: турнирная селекция
+    Crossover,       // GA: скрещивание
+    Mutation,        // GA: мутация
+    Evaluation,      // GA: оценка приспособленности
+    Construction,    // ACO: построение маршрутов муравьями
+    PheromoneUpdate, // ACO: испарение и откладывание феромона
+    Annealing,       // SA: генерация, оценка и применение ходов
+    LocalSearch,     // GA, ACO: локальный поиск 2-opt/Or-opt
+    Decomposition,   // Декомпозиция: решение кластеров и склейка маршрутов
+    Count
+};
+
+const int kSolverPhaseCount = static_cast<int>(SolverPhase::Count);
+const char* solverPhaseName(SolverPhase phase);
+
+// Состояние солвера, передаваемое наблюдателю
+struct SolverProgress {
+    const char* solver;             // "GA", "SA", "ACO", "LK" или "DC" (DecompositionSolver)
+    int iteration;                  // Поколение (GA), итерация (SA, ACO), возмущение (LK) или число кластеров (DC)
+    double bestLength;              // Лучшая найденная длина маршрута
+    double currentLength;           // GA: лучшая особь поколения, SA: текущее решение, ACO: лучший муравей итерации
+    double acceptanceRate;          // SA: доля принятых ходов с прошлого отчета; -1, если не применимо
+    double diversity;               // GA, ACO: коэффициент вариации длин маршрутов поколения; -1, если не применимо
+    long long evaluations;          // Число оценок маршрутов или ходов с начала запуска
+    const double* phaseSeconds;     // Накопленное время по фазам, kSolverPhaseCount элементов
+};
+
+// Наблюдатель за ходом решения. Без наблюдателя солверы ничего не печатают и не замеряют время.
+// Один солвер вызывает методы последовательно, но не обязательно из потока, вызвавшего solve
+// (острова GA сообщают прогресс из потоков пула). Наблюдатель, общий для нескольких одновременно
+// работающих солверов (PortfolioSolver, солверы BatchSolver), вызывается из нескольких потоков
+// сразу и должен быть потокобезопасным, как ConsoleObserver и SolverCounters
+class SolverObserver {
+public:
+    virtual ~SolverObserver() = default;
+    virtual void onStart(const char* /*solver*/, int /*numCities*/) {}
+    virtual void onProgress(const SolverProgress& /*progress*/) {}
+    virtual void onFinish(const SolverProgress& /*progress*/) {}
+};
+
+// Печать прогресса в поток (по умолчанию std::cout) в прежнем формате солверов
+class ConsoleObserver : public SolverObserver {
+public:
+    explicit ConsoleObserver(std::ostream& output);
+    ConsoleObserver();
+
+    void onProgress(const SolverProgress& progress) override;
+    void onFinish(const SolverProgress& progress) override;
+
+private:
+    std::ostream& output;
+    std::mutex mutex;
+};
+
+// Счетчики, которые можно читать из другого потока во время работы солвера. Если наблюдатель
+// общий у нескольких солверов (PortfolioSolver), starts, bestLength и improvements учитывают
+// все солверы, а iterations, evaluations и phaseSeconds - значения из последнего отчета
+class SolverCounters : public SolverObserver {
+public:
+    struct Snapshot {
+        long long starts;
+        long long iterations;
+        long long evaluations;
+        long long improvements;
+        double bestLength;
+        double phaseSeconds[kSolverPhaseCount];
+    };
+
+    SolverCounters();
+
+    void onStart(const char* solver, int numCities) override;
+    void onProgress(const SolverProgress& progress) override;
+    void onFinish(const SolverProgress& progress) override;
+
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<long long> starts;
+    std::atomic<long long> iterations;
+    std::atomic<long long> evaluations;
+    std::atomic<long long> improvements;
+    std::atomic<double> bestLength;
+    std::atomic<double> phaseSeconds[kSolverPhaseCount];
+
+    void record(const SolverProgress& progress);
+};
+
+// Замер времени фаз: при выключенной телеметрии часы не опрашиваются
+class PhaseTimer {
+public:
+    explicit PhaseTimer(bool enabled): enabled(enabled)
+    {
+        if (enabled)
+            last = std::chrono::steady_clock::now();
+    }
+
+    // Добавляет время с прошлой отметки к accumulator
+    void lap(double& accumulator)
+    {
+        if (!enabled)
+            return;
+        auto now = std::chrono::steady_clock::now();
+        accumulator += std::chrono::duration<double>(now - last).count();
+        last = now;
+    }
+
+private:
+    bool enabled;
+    std::chrono::steady_clock::time_point last;
+};
+
+#endif
@@ -0,0 +1,74 @@
+﻿#ifndef STOP_POLICY_H
+#define STOP_POLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Флаг отмены, который можно взвести из любого потока во время работы солвера
+class CancellationToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{ false };
+};
+
+// Условия досрочной остановки. Нулевые значения, а для targetLength - минус бесконечность,
+// означают "без ограничения" (маршрут нулевой длины - допустимая цель); число поколений или
+// итераций, заданное в конструкторе солвера, остается верхней границей
+struct StopPolicy {
+    std::chrono::steady_clock::duration timeLimit = std::chrono::steady_clock::duration::zero(); // Отсчитывается от начала solve
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); // Абсолютный срок
+    double targetLength = -std::numeric_limits<double>::infinity(); // Остановиться, как только найден маршрут не длиннее
+    long long maxEvaluations = 0; // Предел числа оценок маршрутов или ходов
+    int stallIterations = 0;      // Остановиться после стольких поколений/итераций без улучшения
+    std::shared_ptr<const CancellationToken> cancellation;
+};
+
+// Причина завершения solve
+enum class StopReason {
+    None,            // Работа продолжается (промежуточное значение)
+    IterationLimit,  // Выполнены все поколения/итерации
+    Deadline,
+    TargetReached,
+    EvaluationLimit,
+    Stalled,
+    Cancelled
+};
+
+const char* stopReasonName(StopReason reason);
+
+// Лучший найденный маршрут и статистика запуска
+struct SolveResult {
+    std::vector<int> tour;
+    double length = 0.0;
+    StopReason reason = StopReason::None;
+    int iterations = 0;        // Выполнено поколений/итераций
+    long long evaluations = 0;
+    double seconds = 0.0;      // Время работы solve
+};
+
+// Проверка StopPolicy внутри солвера; время отсчитывается от создания объекта
+class StopCondition {
+public:
+    explicit StopCondition(const StopPolicy& policy);
+
+    // Полная проверка между итерациями. stalledIterations - итераций подряд без улучшения
+    StopReason check(double bestLength, long long evaluations, int stalledIterations) const;
+    // Только срок и отмена: для прерывания длинной итерации
+    StopReason interrupted() const;
+    bool stalled(int stalledIterations) const { return policy.stallIterations > 0 && stalledIterations >= policy.stallIterations; }
+    double elapsedSeconds() const;
+
+private:
+    StopPolicy policy;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline;
+};
+
+#endif
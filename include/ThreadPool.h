@@ -0,0 +1,45 @@
+﻿#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+
+// Пул потоков для параллельных циклов внутри солверов.
+// run(count, task) выполняет task(0) ... task(count - 1) и возвращается после завершения всех задач;
+// вызывающий поток тоже выполняет задачи. Исключение из задачи пробрасывается в run
+class ThreadPool {
+public:
+    explicit ThreadPool(int numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+    void run(int count, const std::function<void(int)>& task);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable finished;
+    std::mutex runMutex;                      // run() может вызываться из нескольких потоков по очереди
+
+    const std::function<void(int)>* currentTask = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{ 0 };
+    int activeWorkers = 0;
+    unsigned long long generation = 0;        // Номер текущего вызова run, чтобы рабочие не брали задачу дважды
+    bool stopping = false;
+    std::exception_ptr error;
+
+    void workerLoop();
+    void execute();
+};
+
+#endif
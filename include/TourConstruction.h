@@ -0,0 +1,66 @@
+﻿#ifndef TOUR_CONSTRUCTION_H
+#define TOUR_CONSTRUCTION_H
+
+#include <vector>
+#include <memory>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "KdTree.h"
+#include "Random.h"
+
+// Способ построения начального маршрута
+enum class ConstructionMethod {
+    Random,            // Случайная перестановка
+    NearestNeighbor,   // Ближайший сосед из случайного города
+    Greedy,            // Жадное добавление коротких ребер из списков кандидатов
+    SpaceFillingCurve, // Порядок обхода кривой Гильберта (только для задач с координатами)
+    SpanningTree       // Обход минимального остовного дерева в глубину с пропуском посещенных городов
+};
+
+// Построение начальных маршрутов быстрыми эвристиками. Ребра берутся из списков кандидатов,
+// а ближайший непосещенный город вне списков ищется kd-деревом, поэтому для задач
+// с координатами построение занимает O(N log N); для матрицы поиск вне списков - перебор.
+// Объект не меняется в build, поэтому один экземпляр можно использовать из нескольких потоков
+class TourConstruction {
+public:
+    // Если списки кандидатов не заданы, строятся списки из 10 ближайших соседей
+    TourConstruction(const TspInstance& distances, std::shared_ptr<const CandidateLists> candidates = nullptr,
+                     ConstructionMethod method = ConstructionMethod::NearestNeighbor);
+    TourConstruction(const TourConstruction&) = delete;
+    TourConstruction& operator=(const TourConstruction&) = delete;
+
+    // Разнообразие для популяций: ближайший сосед выбирает следующий город случайно
+    // среди noise ближайших непосещенных (1 - всегда ближайший)
+    void setNoise(int noise);
+
+    ConstructionMethod method() const { return constructionMethod; }
+
+    // Ближайший сосед и обход дерева начинают со случайного города, жадный метод
+    // и кривая Гильберта от random не зависят
+    void build(std::vector<int>& tour, Random& random) const;
+
+private:
+    struct Edge {
+        double length;
+        int from;
+        int to;
+    };
+
+    TspInstance distances;
+    std::shared_ptr<const CandidateLists> candidates;
+    ConstructionMethod constructionMethod;
+    int noise;
+    std::vector<double> x; // Координаты для kd-дерева (пусты для задачи с матрицей)
+    std::vector<double> y;
+    std::unique_ptr<KdTree> tree;
+
+    class NearestSet;
+
+    void nearestNeighbor(std::vector<int>& tour, Random& random) const;
+    void greedy(std::vector<int>& tour) const;
+    void spaceFillingCurve(std::vector<int>& tour) const;
+    void spanningTree(std::vector<int>& tour, Random& random) const;
+    std::vector<Edge> candidateEdges() const;
+};
+
+#endif
@@ -0,0 +1,39 @@
+﻿#ifndef TOUR_EXCHANGE_H
+#define TOUR_EXCHANGE_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+
+// Общий лучший маршрут для солверов, одновременно решающих одну задачу.
+// Длина хранится в атомарной переменной, поэтому проверка "есть ли что-то лучше" ничего
+// не блокирует; маршрут - неизменяемый снимок, указатель на который заменяется атомарно
+// (std::atomic_load / std::atomic_compare_exchange для shared_ptr), и читатели никогда
+// не ждут писателя, копирующего маршрут
+class TourExchange {
+public:
+    TourExchange();
+
+    TourExchange(const TourExchange&) = delete;
+    TourExchange& operator=(const TourExchange&) = delete;
+
+    // Длина общего лучшего маршрута (бесконечность, пока ничего не опубликовано)
+    double bestLength() const { return length.load(std::memory_order_acquire); }
+
+    // Публикация маршрута; возвращает true, если он стал общим лучшим
+    bool publish(const std::vector<int>& tour, double tourLength);
+
+    // Если общий маршрут заметно короче length, он копируется в tour, а его длина - в length
+    bool fetchIfShorter(std::vector<int>& tour, double& tourLength) const;
+
+private:
+    struct Snapshot {
+        std::vector<int> tour;
+        double length;
+    };
+
+    std::atomic<double> length;
+    std::shared_ptr<const Snapshot> snapshot; // Доступ только через атомарные функции shared_ptr
+};
+
+#endif
@@ -0,0 +1,46 @@
+﻿#ifndef TSP_INSTANCE_H
+#define TSP_INSTANCE_H
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include "DistanceMatrix.h"
+#include "CoordinateDistances.h"
+
+// Источник расстояний для солверов: либо явная матрица (DistanceMatrix),
+// либо координаты городов с вычислением расстояний по запросу (CoordinateDistances).
+// Копирование дешевое: данные разделяются через std::shared_ptr
+class TspInstance {
+public:
+    TspInstance(const std::vector<std::vector<double>>& matrix):
+        matrixSource(std::make_shared<DistanceMatrix>(matrix)) {}
+
+    template <typename Source>
+    TspInstance(std::shared_ptr<Source> source)
+    {
+        static_assert(std::is_same<typename std::remove_const<Source>::type, DistanceMatrix>::value ||
+                      std::is_same<typename std::remove_const<Source>::type, CoordinateDistances>::value,
+                      "TspInstance: поддерживаются только DistanceMatrix и CoordinateDistances");
+        assign(std::shared_ptr<const Source>(std::move(source)));
+    }
+
+    int size() const { return matrixSource ? matrixSource->size() : coordinateSource->size(); }
+
+    double operator()(int i, int j) const
+    {
+        return matrixSource ? (*matrixSource)(i, j) : (*coordinateSource)(i, j);
+    }
+
+    bool hasCoordinates() const { return coordinateSource != nullptr; }
+    const std::shared_ptr<const DistanceMatrix>& matrix() const { return matrixSource; }
+    const std::shared_ptr<const CoordinateDistances>& coordinates() const { return coordinateSource; }
+
+private:
+    std::shared_ptr<const DistanceMatrix> matrixSource;
+    std::shared_ptr<const CoordinateDistances> coordinateSource;
+
+    void assign(std::shared_ptr<const DistanceMatrix> source) { matrixSource = std::move(source); }
+    void assign(std::shared_ptr<const CoordinateDistances> source) { coordinateSource = std::move(source); }
+};
+
+#endif
@@ -0,0 +1,56 @@
+﻿#ifndef TSP_SOLVER_INTERFACE_H
+#define TSP_SOLVER_INTERFACE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "TspInstance.h"
+#include "CandidateLists.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TourExchange.h"
+
+// Общий интерфейс солверов. setInstance позволяет решать следующую задачу тем же объектом:
+// параметры алгоритма и выделенная память сохраняются, а списки кандидатов, локальный поиск
+// и построение начального маршрута, привязанные к прежней задаче, сбрасываются (как и маршруты
+// теплого старта)
+class TspSolver {
+public:
+    virtual ~TspSolver() = default;
+
+    virtual std::vector<int> solve() = 0;
+    virtual SolveResult solve(const StopPolicy& policy) = 0;
+    virtual double calculatePathLength(const std::vector<int>& path) = 0;
+    virtual void setInstance(const TspInstance& instance) = 0;
+    virtual void setSeed(std::uint64_t seed) = 0;
+    virtual void setObserver(std::shared_ptr<SolverObserver> observer) = 0;
+    virtual long long getEvaluations() const = 0;
+
+    // Солверы, которые не используют списки кандидатов, их игнорируют
+    virtual void setCandidateLists(std::shared_ptr<const CandidateLists> /*candidateLists*/) {}
+
+    // Теплый старт: следующий solve начинает с этих маршрутов вместо случайных
+    // (GA - включает их в начальную популяцию, SA и LK - начинают с них, ACO - откладывает
+    // по ним феромон и считает лучший из них найденным). Маршруты проверяются в solve
+    void setInitialTours(std::vector<std::vector<int>> tours) { initialTours = std::move(tours); }
+
+    // Обмен лучшими маршрутами с солверами, одновременно решающими ту же задачу (см. PortfolioSolver).
+    // Солвер публикует свои улучшения, а при importShared подхватывает более короткий общий маршрут
+    // (GA - как элитную особь, SA - как текущее состояние, ACO - как маршрут, получающий феромон,
+    // LK - как текущий маршрут). Сбрасывается в setInstance
+    void setExchange(std::shared_ptr<TourExchange> tourExchange, bool importShared = true)
+    {
+        exchange = std::move(tourExchange);
+        importExchange = importShared;
+    }
+
+protected:
+    std::vector<std::vector<int>> initialTours;
+    std::shared_ptr<TourExchange> exchange;
+    bool importExchange = false;
+
+    // Проверка маршрутов теплого старта: каждый должен быть перестановкой городов 0..numCities-1
+    void checkInitialTours(int numCities) const;
+};
+
+#endif
@@ -0,0 +1,23 @@
+﻿#ifndef TSPLIB_READER_H
+#define TSPLIB_READER_H
+
+#include <string>
+#include <istream>
+#include "TspInstance.h"
+
+// Задача, прочитанная из файла в формате TSPLIB (.tsp)
+struct TsplibProblem {
+    std::string name;
+    std::string comment;
+    TspInstance instance;
+};
+
+// Потоковый разбор .tsp файла. Поддерживаются NODE_COORD_SECTION с метриками
+// EUC_2D, CEIL_2D, GEO, ATT (в память загружаются только координаты) и
+// EDGE_WEIGHT_SECTION с явной матрицей (FULL_MATRIX, UPPER/LOWER_ROW, UPPER/LOWER_DIAG_ROW
+// и их столбцовые аналоги). Принимается только TYPE: TSP: все солверы рассчитаны на симметричные
+// расстояния. При ошибке разбора и для TYPE: ATSP бросается std::runtime_error
+TsplibProblem readTsplib(std::istream& input, int cacheSlotsPerRow = 0);
+TsplibProblem readTsplibFile(const std::string& path, int cacheSlotsPerRow = 0);
+
+#endif
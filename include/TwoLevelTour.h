@@ -0,0 +1,97 @@
+﻿#ifndef TWO_LEVEL_TOUR_H
+#define TWO_LEVEL_TOUR_H
+
+#include <vector>
+
+// Число городов, начиная с которого локальный поиск хранит маршрут двухуровневым списком
+const int kTwoLevelTourMinCities = 8000;
+
+// Двухуровневый список: маршрут разбит на сегменты примерно по sqrt(N) городов,
+// у каждого сегмента есть флаг обращения. Соседи и between находятся за O(1),
+// 2-opt ход стоит O(sqrt(N)): внутри сегмента города переставляются, а длинный участок
+// инвертируется перестановкой целых сегментов с переключением их флагов.
+// Интерфейс совпадает с ArrayTour, поэтому локальный поиск работает с обоими представлениями
+class TwoLevelTour {
+public:
+    void assign(const std::vector<int>& cities);
+
+    std::vector<int> cities() const; // Маршрут в виде массива, начиная с первого сегмента
+    int size() const { return numCities; }
+    int cityAt(int index) const;     // Город на позиции index от начала маршрута, O(sqrt(N))
+
+    int next(int city) const
+    {
+        const Segment& segment = segments[segmentOf[city]];
+        int index = indexOf[city] + (segment.reversed ? -1 : 1);
+        if (index >= 0 && index < static_cast<int>(segment.cities.size()))
+            return segment.cities[index];
+        int rank = segment.rank + 1;
+        return firstCity(order[rank == static_cast<int>(order.size()) ? 0 : rank]);
+    }
+
+    int prev(int city) const
+    {
+        const Segment& segment = segments[segmentOf[city]];
+        int index = indexOf[city] + (segment.reversed ? 1 : -1);
+        if (index >= 0 && index < static_cast<int>(segment.cities.size()))
+            return segment.cities[index];
+        int rank = segment.rank == 0 ? static_cast<int>(order.size()) - 1 : segment.rank - 1;
+        return lastCity(order[rank]);
+    }
+
+    // Лежит ли b на пути от a до c в прямом направлении (концы включаются)
+    bool between(int a, int b, int c) const;
+
+    // Замена ребер (a, b) и (c, d) на (a, c) и (b, d), как в ArrayTour::twoOptMove
+    void twoOptMove(int a, int b, int c, int d);
+
+    // Участок из length1 городов, начинающийся с first, меняется местами со следующим
+    // за ним участком из length2 городов (ход double bridge)
+    void swapSegments(int first, int length1, int length2);
+
+private:
+    struct Segment {
+        std::vector<int> cities; // Города в порядке хранения
+        bool reversed = false;   // Сегмент обходится от конца к началу
+        int rank = 0;            // Позиция сегмента в order
+    };
+
+    int numCities = 0;
+    int groupSize = 0;              // Размер сегмента после перестроения
+    int maxSegments = 0;            // При большем числе сегментов список перестраивается
+    std::vector<Segment> segments;  // Пул сегментов; используются первые segmentCount
+    int segmentCount = 0;
+    std::vector<int> order;         // Номера сегментов в порядке обхода
+    std::vector<int> segmentOf;     // Сегмент каждого города
+    std::vector<int> indexOf;       // Индекс города в cities своего сегмента
+    std::vector<int> buffer;        // Маршрут при перестроении
+
+    int firstCity(int segment) const
+    {
+        const Segment& s = segments[segment];
+        return s.reversed ? s.cities.back() : s.cities.front();
+    }
+
+    int lastCity(int segment) const
+    {
+        const Segment& s = segments[segment];
+        return s.reversed ? s.cities.front() : s.cities.back();
+    }
+
+    int cityAtOffset(int segment, int at) const
+    {
+        const Segment& s = segments[segment];
+        return s.cities[s.reversed ? s.cities.size() - 1 - at : at];
+    }
+
+    int offset(int city) const;        // Номер города внутри сегмента по направлению обхода
+    int advance(int city, int steps) const; // Город через steps шагов вперед
+    long long key(int city) const;     // Позиция города от начала маршрута, сохраняющая порядок
+    void split(int segment, int at);   // Города с номера at уходят в новый сегмент сразу после исходного
+    void splitBefore(int city);        // Город становится первым в своем сегменте
+    void reverse(int from, int to);    // Инверсия пути from..to, не проходящего через начало маршрута
+    void renumber(int fromRank, int toRank);
+    void rebuild();
+};
+
+#endif
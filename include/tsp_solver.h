@@ -1,8 +1,26 @@
 #ifndef TSP_SOLVER_H
 #define TSP_SOLVER_H
 
+#include "DistanceMatrix.h"
+#include "CoordinateDistances.h"
+#include "TspInstance.h"
+#include "TsplibReader.h"
+#include "MatrixFile.h"
+#include "CandidateLists.h"
+#include "LocalSearch.h"
+#include "TourConstruction.h"
+#include "Random.h"
+#include "ThreadPool.h"
+#include "SolverObserver.h"
+#include "StopPolicy.h"
+#include "TspSolver.h"
 #include "AntColony.h"
 #include "GeneticAlgorithmTSP.h"
 #include "SimulatedAnnealing.h"
+#include "LinKernighan.h"
+#include "BatchSolver.h"
+#include "InstanceEdits.h"
+#include "DecompositionSolver.h"
+#include "PortfolioSolver.h"
 
 #endif 
\ No newline at end of file
@@ -1,139 +1,721 @@
 #include "AntColony.h"
+#include <stdexcept>
+
+namespace {
+
+// Порог общего множителя феромонов: ниже него множитель переносится в сами значения,
+// чтобы они не выходили за пределы диапазона double
+const double kMinPheromoneScale = 1e-30;
+
+// Поиск по префиксным суммам весов: первый город с ненулевым весом, на котором сумма достигает randomChoice
+int rouletteSelect(const double* weights, int count, double randomChoice)
+{
+    double cumulativeProbability = 0.0;
+    for (int c = 0; c < count; ++c)
+    {
+        cumulativeProbability += weights[c];
+        if (cumulativeProbability >= randomChoice && weights[c] > 0.0)
+            return c;
+    }
+    // Из-за погрешности округления сумма могла не достичь randomChoice
+    for (int c = count - 1; c >= 0; --c)
+    {
+        if (weights[c] > 0.0)
+            return c;
+    }
+    return -1;
+}
+
+// Таблица нужного размера: буфер прежнего размера переиспользуется, иначе освобождается до
+// выделения нового, чтобы смена режима (N * N <-> N * k) не держала в памяти оба
+void resizeTable(std::vector<double>& table, size_t size)
+{
+    if (table.size() == size)
+        return;
+    if (table.capacity() != size)
+        std::vector<double>().swap(table);
+    table.resize(size);
+}
+
+}
 
 AntColony::AntColony(const std::vector<std::vector<double>>& distMatrix, int numAnts, 
                                              int maxIterations, double alpha, double beta, double evaporationRate, double q): 
-      distanceMatrix(distMatrix), 
+      AntColony(TspInstance(distMatrix), numAnts, maxIterations, alpha, beta, evaporationRate, q) {}
+
+AntColony::AntColony(const TspInstance& distances, int numAnts, 
+                                             int maxIterations, double alpha, double beta, double evaporationRate, double q): 
+      distances(distances), 
       numAnts(numAnts), 
       maxIterations(maxIterations), 
       alpha(alpha), 
       beta(beta), 
       evaporationRate(evaporationRate), 
       q(q), 
-      bestPathLength(std::numeric_limits<double>::infinity()) 
+      bestPathLength(std::numeric_limits<double>::infinity()),
+      seed(Random::randomSeed()),
+      numThreads(1)
+{
+    // Феромоны выделяются в solve() под активный режим (N * N или N * k)
+}
+
+// Новая задача для того же объекта: колония начинает заново, буфер феромонов того же
+// размера переиспользуется в solve()
+void AntColony::setInstance(const TspInstance& instance)
+{
+    distances = instance;
+    pheromones.clear();
+    pheromoneScale = 1.0;
+    freshPheromones = true;
+    bestPath.clear();
+    bestPathLength = std::numeric_limits<double>::infinity();
+    candidates.reset();
+    localSearch.reset();
+    initialTours.clear();
+    exchange.reset();
+}
+
+// Новая задача, полученная правкой прежней (см. InstanceEdits.h): previousIndex[i] - номер
+// города i в прежней задаче или -1 для нового города. Феромоны ребер между сохранившимися
+// городами переносятся, ребра к новым городам получают средний уровень прежней матрицы.
+// Лучший маршрут сбрасывается - восстановленный маршрут передается через setInitialTours.
+// Разреженные феромоны привязаны к спискам кандидатов прежней задачи и не переносятся
+void AntColony::setInstance(const TspInstance& instance, const std::vector<int>& previousIndex)
+{
+    const size_t oldSize = distances.size();
+    const size_t newSize = instance.size();
+    if (previousIndex.size() != newSize)
+        throw std::invalid_argument("AntColony: размер отображения городов не совпадает с размером задачи");
+    for (int city : previousIndex)
+        if (city < -1 || city >= static_cast<int>(oldSize))
+            throw std::invalid_argument("AntColony: номер города прежней задачи вне диапазона");
+    if (pheromones.size() != oldSize * oldSize)
+    {
+        setInstance(instance);
+        return;
+    }
+    normalizePheromones();
+
+    double mean = 1.0;
+    if (oldSize > 1)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < oldSize; ++i)
+            for (size_t j = 0; j < oldSize; ++j)
+                if (i != j)
+                    sum += pheromones[i * oldSize + j];
+        mean = sum / (oldSize * (oldSize - 1));
+    }
+    std::vector<double> remapped(newSize * newSize, mean);
+    for (size_t i = 0; i < newSize; ++i)
+    {
+        if (previousIndex[i] < 0)
+            continue;
+        for (size_t j = 0; j < newSize; ++j)
+            if (previousIndex[j] >= 0)
+                remapped[i * newSize + j] = pheromones[previousIndex[i] * oldSize + previousIndex[j]];
+    }
+
+    setInstance(instance);
+    pheromones.swap(remapped);
+    freshPheromones = false;
+}
+
+// Возврат феромонов к начальному уровню. Без вызова феромоны и лучший маршрут переходят
+// из одного запуска solve в следующий (продолжение поиска на той же задаче)
+void AntColony::resetPheromones()
+{
+    std::fill(pheromones.begin(), pheromones.end(), 1.0);
+    pheromoneScale = 1.0;
+    freshPheromones = true;
+    bestPath.clear();
+    bestPathLength = std::numeric_limits<double>::infinity();
+}
+
+// Ограничение выбора следующего города списками ближайших соседей
+void AntColony::setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists)
+{
+    candidates = std::move(candidateLists);
+    if (sparsePheromones)
+        pheromones.clear(); // Разреженные феромоны привязаны к спискам - начинаем заново в solve()
+}
+
+// Режим MAX-MIN: феромон откладывает только лучший муравей итерации, уровни ограничены
+// [tau_min, tau_max], где tau_max = q / (rho * L_best), а tau_min следует из вероятности
+// bestProbability построить лучший маршрут при сходимости. Начальный уровень - tau_max
+void AntColony::setMaxMin(bool enabled, double probability)
+{
+    maxMin = enabled;
+    bestProbability = std::max(1e-6, std::min(probability, 0.999));
+    minPheromone = 0.0;
+    maxPheromone = std::numeric_limits<double>::infinity();
+}
+
+// Феромоны хранятся только для ребер из списков кандидатов (N * k вместо N * N); остальные
+// ребра считаются лежащими на нижней границе. Требует списков кандидатов и режима MAX-MIN.
+// Переключение режима начинает феромоны заново
+void AntColony::setSparsePheromones(bool enabled)
+{
+    sparsePheromones = enabled;
+    std::vector<double>().swap(pheromones);
+}
+
+// Каждый построенный маршрут доводится локальным поиском до локального оптимума,
+// и феромон откладывается уже на улучшенные маршруты
+void AntColony::setLocalSearch(std::shared_ptr<const LocalSearch> newLocalSearch)
+{
+    localSearch = std::move(newLocalSearch);
+}
+
+// Зерно генератора: при одинаковых зерне и числе потоков результат повторяется
+void AntColony::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+// Параллельное построение маршрутов муравьев на пуле из threads потоков
+void AntColony::setThreads(int threads)
+{
+    numThreads = std::max(1, threads);
+    threadPool.reset(numThreads > 1 ? new ThreadPool(numThreads) : nullptr);
+}
+
+// Выполнение task(block) для блоков [0, blocks) на пуле потоков либо последовательно
+void AntColony::runBlocks(int blocks, const std::function<void(int)>& task)
 {
-    pheromones = std::vector<std::vector<double>>(distanceMatrix.size(), std::vector<double>(distanceMatrix.size(), 1.0)); 
+    if (threadPool)
+        threadPool->run(blocks, task);
+    else
+        for (int block = 0; block < blocks; ++block)
+            task(block);
 }
 
-//   
+// Вычисление длины маршрута
 double AntColony::calculatePathLength(const std::vector<int>& path) 
 {
     double length = 0;
     for (int i = 0; i != path.size() - 1; ++i) 
     {
-        length += distanceMatrix[path[i]][path[i + 1]];
+        length += distances(path[i], path[i + 1]);
     }
-    length += distanceMatrix[path.back()][path[0]];
+    length += distances(path.back(), path[0]);
     return length;
 }
 
+// Номер ячейки феромона ребра (from, to); -1, если ребро не хранится (разреженный режим)
+std::ptrdiff_t AntColony::pheromoneIndex(int from, int to) const
+{
+    if (!sparsePheromones)
+        return static_cast<std::ptrdiff_t>(from) * distances.size() + to;
+    const int count = candidates->count();
+    const int* neighbors = candidates->begin(from);
+    for (int c = 0; c < count; ++c)
+        if (neighbors[c] == to)
+            return static_cast<std::ptrdiff_t>(from) * count + c;
+    return -1;
+}
+
 void AntColony::placePheromones(const std::vector<int>& path, double pathLength) 
 {
-    //    - ,        
-    double pheromoneDeposit = q / pathLength;
-    for (size_t i = 0; i < path.size() - 1; ++i) 
+    // Если путь содержит какое-то ребро, то количество феромона на этом ребре увеличивается
+    // (с учетом общего множителя и верхней границы MAX-MIN)
+    double pheromoneDeposit = q / pathLength / pheromoneScale;
+    double ceiling = maxPheromone / pheromoneScale;
+    for (size_t i = 0; i < path.size(); ++i) 
     {
-        pheromones[path[i]][path[i + 1]] += pheromoneDeposit;
-        pheromones[path[i + 1]][path[i]] += pheromoneDeposit;
+        int from = path[i];
+        int to = path[(i + 1) % path.size()];
+        std::ptrdiff_t forward = pheromoneIndex(from, to);
+        std::ptrdiff_t backward = pheromoneIndex(to, from);
+        if (forward >= 0)
+            pheromones[forward] = std::min(pheromones[forward] + pheromoneDeposit, ceiling);
+        if (backward >= 0)
+            pheromones[backward] = std::min(pheromones[backward] + pheromoneDeposit, ceiling);
     }
-    pheromones[path.back()][path[0]] += pheromoneDeposit;
-    pheromones[path[0]][path.back()] += pheromoneDeposit;
+    freshPheromones = false;
 }
 
-//   
+// Перенос общего множителя в значения (и ограничение уровней в режиме MAX-MIN)
+void AntColony::normalizePheromones()
+{
+    for (double& pheromone : pheromones)
+    {
+        pheromone *= pheromoneScale;
+        if (maxMin)
+            pheromone = std::max(minPheromone, std::min(pheromone, maxPheromone));
+    }
+    pheromoneScale = 1.0;
+}
+
+// Границы MAX-MIN по текущему лучшему маршруту; нетронутые феромоны поднимаются до tau_max
+// (тогда возвращается true - изменились все значения)
+bool AntColony::updateBounds()
+{
+    if (!maxMin || bestPathLength == std::numeric_limits<double>::infinity())
+        return false;
+    const double n = distances.size();
+    maxPheromone = q / (evaporationRate * bestPathLength);
+    double root = pow(bestProbability, 1.0 / n);
+    minPheromone = std::min(maxPheromone, maxPheromone * (1.0 - root) / (std::max(1.0, n / 2.0 - 1.0) * root));
+    if (freshPheromones)
+    {
+        std::fill(pheromones.begin(), pheromones.end(), maxPheromone);
+        pheromoneScale = 1.0;
+        freshPheromones = false;
+        return true;
+    }
+    return false;
+}
+
+// Обновление феромонов. Испарение ленивое: уменьшается только общий множитель, поэтому
+// итерация стоит O(числа отложенных ребер), а не O(N^2)
 void AntColony::updatePheromones(const std::vector<std::vector<int>>& paths, const std::vector<double>& pathLengths) 
 {
-    for (size_t i = 0; i < pheromones.size(); ++i) 
+    bool rescaled = false; // Изменились все значения - таблицу выбора нужно пересчитать целиком
+    pheromoneScale *= 1.0 - evaporationRate;
+    if (pheromoneScale < kMinPheromoneScale)
+    {
+        normalizePheromones();
+        rescaled = true;
+    }
+
+    size_t deposited = 0;
+    int iterationBest = -1;
+    if (maxMin)
     {
-        for (size_t j = 0; j < pheromones[i].size(); ++j) 
+        rescaled = updateBounds() || rescaled;
+        for (size_t i = 0; i < paths.size(); ++i)
+            if (iterationBest < 0 || pathLengths[i] < pathLengths[iterationBest])
+                iterationBest = static_cast<int>(i);
+        placePheromones(paths[iterationBest], pathLengths[iterationBest]);
+        deposited = 1;
+    }
+    else
+    {
+        for (size_t i = 0; i < paths.size(); ++i) 
         {
-            pheromones[i][j] *= (1.0 - evaporationRate);
+            placePheromones(paths[i], pathLengths[i]);
         }
+        deposited = paths.size();
     }
 
-    for (size_t i = 0; i < paths.size(); ++i) 
+    // Таблицу выбора по спискам кандидатов (N * k) дешевле пересчитать целиком,
+    // полную (N * N) - только в ячейках ребер, получивших феромон
+    if (candidates || choiceInfo.size() <= 2 * deposited * distances.size() || rescaled)
+        updateChoiceInfo();
+    else if (maxMin)
+        refreshChoiceInfo(paths[iterationBest]);
+    else
+        for (const std::vector<int>& path : paths)
+            refreshChoiceInfo(path);
+}
+
+// Пересчет ячеек таблицы выбора (без списков кандидатов) для ребер маршрута
+void AntColony::refreshChoiceInfo(const std::vector<int>& path)
+{
+    const size_t numCities = distances.size();
+    for (size_t i = 0; i < path.size(); ++i)
     {
-        placePheromones(paths[i], pathLengths[i]);
+        size_t from = path[i];
+        size_t to = path[(i + 1) % path.size()];
+        size_t forward = from * numCities + to;
+        size_t backward = to * numCities + from;
+        choiceInfo[forward] = pow(pheromones[forward], alpha) * heuristic[forward];
+        choiceInfo[backward] = pow(pheromones[backward], alpha) * heuristic[backward];
     }
 }
 
-//   
-std::vector<int> AntColony::constructSolution() 
+// eta^beta = (1 / d)^beta; нулевые расстояния (совпадающие города) заменяются малым числом
+double AntColony::heuristicValue(int from, int to)
 {
-    std::vector<int> path;
-    std::vector<bool> visited(distanceMatrix.size(), false);
-    int startCity = rand() % distanceMatrix.size();
-    path.push_back(startCity);
-    visited[startCity] = true;
+    const double minDistance = 1e-10;
+    return pow(1.0 / std::max(distances(from, to), minDistance), beta);
+}
 
-    for (size_t step = 1; step != distanceMatrix.size(); ++step) 
+// Феромоны под активный режим: N * k по спискам кандидатов (sparsePheromones) или N * N.
+// Таблица того же размера сохраняется, иначе выделяется заново с начальным уровнем
+void AntColony::allocatePheromones()
+{
+    const size_t pheromoneCount = static_cast<size_t>(distances.size()) * (sparsePheromones ? candidates->count() : distances.size());
+    if (pheromones.size() == pheromoneCount)
+        return;
+    resizeTable(pheromones, pheromoneCount);
+    std::fill(pheromones.begin(), pheromones.end(), 1.0);
+    pheromoneScale = 1.0;
+    freshPheromones = true;
+}
+
+// Кэширование eta^beta: вычисляется один раз за запуск, так как не зависит от феромонов.
+// Со списками кандидатов таблицы имеют размер N * k, без них - N * N
+void AntColony::initializeHeuristic()
+{
+    allocatePheromones(); // choiceInfo зависит от феромонов
+    const int numCities = distances.size();
+    if (candidates)
     {
-        int currentCity = path.back();
-        std::vector<double> probabilities(distanceMatrix.size(), 0.0);
-        double totalProbability = 0.0;
+        const int count = candidates->count();
+        resizeTable(heuristic, static_cast<size_t>(numCities) * count);
+        for (int i = 0; i < numCities; ++i)
+            for (int c = 0; c < count; ++c)
+                heuristic[static_cast<size_t>(i) * count + c] = heuristicValue(i, candidates->get(i, c));
+    }
+    else
+    {
+        resizeTable(heuristic, static_cast<size_t>(numCities) * numCities);
+        for (int i = 0; i < numCities; ++i)
+            for (int j = 0; j < numCities; ++j)
+                heuristic[static_cast<size_t>(i) * numCities + j] = i == j ? 0.0 : heuristicValue(i, j);
+    }
+    resizeTable(choiceInfo, heuristic.size());
+    updateChoiceInfo();
+}
 
-        for (size_t nextCity = 0; nextCity < distanceMatrix.size(); ++nextCity) 
+// Пересчет таблицы tau^alpha * eta^beta после изменения феромонов (строки делятся между потоками)
+void AntColony::updateChoiceInfo()
+{
+    const size_t numCities = distances.size();
+    const size_t count = candidates ? candidates->count() : numCities;
+    const int blocks = static_cast<int>(std::min<size_t>(numThreads, numCities));
+    const double floor = pheromoneFloor();
+    runBlocks(blocks, [&](int block) {
+        size_t rowBegin = numCities * block / blocks;
+        size_t rowEnd = numCities * (block + 1) / blocks;
+        for (size_t i = rowBegin; i < rowEnd; ++i)
         {
-            if (!visited[nextCity]) 
+            const double* heuristicRow = heuristic.data() + i * count;
+            double* choiceRow = choiceInfo.data() + i * count;
+            if (sparsePheromones)
+            {
+                const double* pheromoneRow = pheromones.data() + i * count;
+                for (size_t c = 0; c < count; ++c)
+                    choiceRow[c] = pow(std::max(pheromoneRow[c], floor), alpha) * heuristicRow[c];
+            }
+            else if (candidates)
             {
-                double pheromone = pow(pheromones[currentCity][nextCity], alpha);
-                double distance = pow(1.0 / distanceMatrix[currentCity][nextCity], beta);
-                probabilities[nextCity] = pheromone * distance;
-                totalProbability += probabilities[nextCity];
+                const double* pheromoneRow = pheromones.data() + i * numCities;
+                const int* neighbors = candidates->begin(i);
+                for (size_t c = 0; c < count; ++c)
+                    choiceRow[c] = pow(std::max(pheromoneRow[neighbors[c]], floor), alpha) * heuristicRow[c];
+            }
+            else if (alpha == 1.0)
+            {
+                const double* pheromoneRow = pheromones.data() + i * numCities;
+                for (size_t j = 0; j < count; ++j)
+                    choiceRow[j] = std::max(pheromoneRow[j], floor) * heuristicRow[j];
+            }
+            else
+            {
+                const double* pheromoneRow = pheromones.data() + i * numCities;
+                for (size_t j = 0; j < count; ++j)
+                    choiceRow[j] = pow(std::max(pheromoneRow[j], floor), alpha) * heuristicRow[j];
             }
         }
+    });
+}
+
+// Рулетка только среди непосещенных кандидатов; -1, если все кандидаты уже посещены
+int AntColony::selectFromCandidates(AntWorkspace& workspace, int currentCity)
+{
+    const int count = candidates->count();
+    const int* neighbors = candidates->begin(currentCity);
+    const double* choice = choiceInfo.data() + static_cast<size_t>(currentCity) * count;
+    const double* unvisited = workspace.unvisited.data();
+    double* weights = workspace.selectionWeights.data();
+
+    // Маскированная сумма без ветвлений: у посещенных городов множитель 0
+    double totalProbability = 0.0;
+    for (int c = 0; c < count; ++c)
+    {
+        weights[c] = choice[c] * unvisited[neighbors[c]];
+        totalProbability += weights[c];
+    }
+    if (totalProbability <= 0.0)
+        return -1;
+
+    double randomChoice = workspace.random.uniform() * totalProbability;
+    return neighbors[rouletteSelect(weights, count, randomChoice)];
+}
 
-        double randomChoice = ((double)rand() / RAND_MAX) * totalProbability;
-        double cumulativeProbability = 0.0;
+// Ближайший непосещенный город. В разреженном режиме все ребра вне списков кандидатов
+// лежат на нижней границе, поэтому лучший по tau^alpha * eta^beta город - ближайший;
+// его выбор вместо рулетки по всем городам стоит O(log N) для задач с координатами
+int AntColony::nearestUnvisited(AntWorkspace& workspace, int currentCity)
+{
+    if (tree)
+        return tree->nearestIn(workspace.remaining, coordinateX[currentCity], coordinateY[currentCity]);
+    const int numCities = distances.size();
+    int best = -1;
+    for (int city = 0; city < numCities; ++city)
+        if (workspace.unvisited[city] > 0.0 && (best < 0 || distances(currentCity, city) < distances(currentCity, best)))
+            best = city;
+    return best;
+}
 
-        for (size_t nextCity = 0; nextCity < distanceMatrix.size(); ++nextCity) 
+// Рулетка по всем непосещенным городам
+int AntColony::selectFromAll(AntWorkspace& workspace, int currentCity)
+{
+    const int numCities = distances.size();
+    const double* unvisited = workspace.unvisited.data();
+    double* weights = workspace.selectionWeights.data();
+    double totalProbability = 0.0;
+
+    const double floor = pheromoneFloor();
+    if (candidates)
+    {
+        // Таблица выбора построена только для кандидатов - остальные веса вычисляются на месте
+        const double* pheromoneRow = pheromones.data() + static_cast<size_t>(currentCity) * numCities;
+        for (int nextCity = 0; nextCity < numCities; ++nextCity)
         {
-            if (!visited[nextCity]) 
-            {
-                cumulativeProbability += probabilities[nextCity];
-                if (cumulativeProbability >= randomChoice) 
-                {
-                    path.push_back(nextCity);
-                    visited[nextCity] = true;
-                    break;
-                }
-            }
+            weights[nextCity] = unvisited[nextCity] > 0.0
+                ? pow(std::max(pheromoneRow[nextCity], floor), alpha) * heuristicValue(currentCity, nextCity) : 0.0;
+            totalProbability += weights[nextCity];
+        }
+    }
+    else
+    {
+        // Ячейки таблицы выбора обновляются только для ребер с отложенным феромоном,
+        // поэтому нижняя граница MAX-MIN учитывается здесь
+        const double floorWeight = floor > 0.0 ? pow(floor, alpha) : 0.0;
+        const double* choice = choiceInfo.data() + static_cast<size_t>(currentCity) * numCities;
+        const double* heuristicRow = heuristic.data() + static_cast<size_t>(currentCity) * numCities;
+        for (int nextCity = 0; nextCity < numCities; ++nextCity)
+        {
+            weights[nextCity] = std::max(choice[nextCity], floorWeight * heuristicRow[nextCity]) * unvisited[nextCity];
+            totalProbability += weights[nextCity];
         }
     }
 
-    return path;  //    
+    double randomChoice = workspace.random.uniform() * totalProbability;
+    int nextCity = rouletteSelect(weights, numCities, randomChoice);
+    if (nextCity < 0) // Все веса нулевые (например, феромон исчез) - первый непосещенный город
+        nextCity = static_cast<int>(std::find(unvisited, unvisited + numCities, 1.0) - unvisited);
+    return nextCity;
 }
 
+// Построение маршрута муравья; path заполняется заново, его память переиспользуется
+void AntColony::constructSolution(AntWorkspace& workspace, std::vector<int>& path) 
+{
+    const int numCities = distances.size();
+    std::vector<double>& unvisited = workspace.unvisited;
+    path.clear();
+    path.reserve(numCities);
+    unvisited.assign(numCities, 1.0);
+    workspace.selectionWeights.resize(numCities);
+    int startCity = workspace.random.below(numCities);
+    path.push_back(startCity);
+    unvisited[startCity] = 0.0;
+    if (tree)
+    {
+        tree->fillSubset(workspace.remaining, true);
+        tree->erase(workspace.remaining, startCity);
+    }
+
+    for (int step = 1; step != numCities; ++step) 
+    {
+        int currentCity = path.back();
+        int nextCity = candidates ? selectFromCandidates(workspace, currentCity) : -1;
+        if (nextCity < 0) // Все кандидаты посещены - ближайший город либо полный перебор
+            nextCity = sparsePheromones ? nearestUnvisited(workspace, currentCity) : selectFromAll(workspace, currentCity);
+        path.push_back(nextCity);
+        unvisited[nextCity] = 0.0;
+        if (tree)
+            tree->erase(workspace.remaining, nextCity);
+    }
+}
+
+// Передача состояния наблюдателю: лучший муравей итерации и разброс длин маршрутов
+void AntColony::reportProgress(int iteration, const std::vector<double>& pathLengths, const double* phaseSeconds, bool finished)
+{
+    double iterationBest = std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    int count = 0;
+    for (double length : pathLengths)
+    {
+        if (length == std::numeric_limits<double>::infinity()) // Муравей прерванной итерации
+            continue;
+        iterationBest = std::min(iterationBest, length);
+        sum += length;
+        sumSquares += length * length;
+        ++count;
+    }
+    double mean = count > 0 ? sum / count : 0.0;
+    double variance = count > 0 ? std::max(0.0, sumSquares / count - mean * mean) : 0.0;
+
+    SolverProgress progress = { "ACO", iteration, bestPathLength, iterationBest, -1.0,
+                                mean > 0.0 ? std::sqrt(variance) / mean : -1.0, evaluations, phaseSeconds };
+    if (finished)
+        observer->onFinish(progress);
+    else
+        observer->onProgress(progress);
+}
+
+// Наблюдатель получает прогресс после каждой итерации; без него ничего не печатается
+void AntColony::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
 
 std::vector<int> AntColony::solve() 
 {
-    for (int iteration = 0; iteration != maxIterations; ++iteration) 
+    return solve(StopPolicy()).tour;
+}
+
+// Запуск с условиями остановки. Срок и отмена проверяются и перед каждым муравьем:
+// прерванная итерация дает только достроенные маршруты, феромоны после нее не обновляются
+SolveResult AntColony::solve(const StopPolicy& policy)
+{
+    checkInitialTours(distances.size());
+    if (sparsePheromones && !(candidates && maxMin))
+        throw std::invalid_argument("AntColony: разреженные феромоны требуют списков кандидатов и режима MAX-MIN");
+    StopCondition stop(policy);
+    SolveResult result;
+    double phaseSeconds[kSolverPhaseCount] = {};
+    PhaseTimer timer(observer != nullptr);
+    if (observer)
+        observer->onStart("ACO", distances.size());
+
+    allocatePheromones();
+    tree.reset();
+    if (sparsePheromones && distances.hasCoordinates())
     {
-        std::vector<std::vector<int>> paths;
-        std::vector<double> pathLengths;
+        const CoordinateDistances& coordinates = *distances.coordinates();
+        coordinateX.resize(distances.size());
+        coordinateY.resize(distances.size());
+        for (int i = 0; i < distances.size(); ++i)
+        {
+            coordinateX[i] = coordinates.getX(i);
+            coordinateY[i] = coordinates.getY(i);
+        }
+        tree.reset(new KdTree(coordinateX, coordinateY));
+    }
+
+    // Теплый старт: лучший из заданных маршрутов становится текущим лучшим, по всем откладывается феромон
+    for (const std::vector<int>& tour : initialTours)
+    {
+        double length = calculatePathLength(tour);
+        if (length < bestPathLength)
+        {
+            bestPathLength = length;
+            bestPath = tour;
+        }
+    }
+    updateBounds();
+    for (const std::vector<int>& tour : initialTours)
+        placePheromones(tour, calculatePathLength(tour));
+    initializeHeuristic();
+
+    // Каждый блок муравьев строится своим потоком генератора, полученным из общего зерна.
+    // Разбиение на блоки фиксировано, поэтому результат не зависит от планирования потоков
+    const int blocks = std::max(1, std::min(numThreads, numAnts));
+    Random master(seed);
+    workspaces.resize(blocks);
+    for (AntWorkspace& workspace : workspaces)
+        workspace.random = master.split();
+
+    std::vector<std::vector<int>> paths(numAnts);
+    std::vector<double> pathLengths(numAnts);
+    evaluations = 0;
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+
+    int noImprovementIterations = 0;
+    result.reason = StopReason::IterationLimit;
+    int iteration = 0;
+    for (; iteration != maxIterations; ++iteration) 
+    {
+        StopReason reason = stop.check(bestPathLength, evaluations, noImprovementIterations);
+        if (reason != StopReason::None)
+        {
+            result.reason = reason;
+            break;
+        }
 
+        std::atomic<bool> interrupted{ false };
+        runBlocks(blocks, [&](int block) {
+            int antBegin = numAnts * block / blocks;
+            int antEnd = numAnts * (block + 1) / blocks;
+            for (int ant = antBegin; ant < antEnd; ++ant)
+            {
+                if (interrupted.load(std::memory_order_relaxed) || stop.interrupted() != StopReason::None)
+                {
+                    interrupted.store(true, std::memory_order_relaxed);
+                    pathLengths[ant] = std::numeric_limits<double>::infinity(); // Муравей не построен
+                    continue;
+                }
+                constructSolution(workspaces[block], paths[ant]);  // Строим путь муравья
+                pathLengths[ant] = calculatePathLength(paths[ant]);
+            }
+        });
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Construction)]);
+
+        if (localSearch)
+        {
+            runBlocks(blocks, [&](int block) {
+                int antBegin = numAnts * block / blocks;
+                int antEnd = numAnts * (block + 1) / blocks;
+                for (int ant = antBegin; ant < antEnd; ++ant)
+                {
+                    if (pathLengths[ant] == std::numeric_limits<double>::infinity())
+                        continue;
+                    pathLengths[ant] += localSearch->improve(paths[ant], workspaces[block].localSearch);
+                }
+            });
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+        }
+
+        // Обновляем лучший путь (в порядке номеров муравьев)
+        bool improved = false;
         for (int ant = 0; ant < numAnts; ++ant) 
         {
-            std::vector<int> antPath = constructSolution();  //   
-            double pathLength = calculatePathLength(antPath);
-            paths.push_back(antPath);
-            pathLengths.push_back(pathLength);
+            if (pathLengths[ant] == std::numeric_limits<double>::infinity())
+                continue;
+            ++evaluations;
+            if (pathLengths[ant] < bestPathLength) 
+            {
+                bestPathLength = pathLengths[ant];
+                bestPath = paths[ant];
+                improved = true;
+            }
+        }
+        noImprovementIterations = improved ? 0 : noImprovementIterations + 1;
+
+        if (interrupted)
+        {
+            result.reason = stop.interrupted();
+            break;
+        }
 
-            //   
-            if (pathLength < bestPathLength) 
+        // Обмен с другими солверами портфеля: лучший маршрут публикуется, а более короткий общий
+        // маршрут заменяет маршрут худшего муравья и получает феромон вместе с остальными
+        if (exchange)
+        {
+            if (bestPathLength < exchange->bestLength())
+            {
+                exchange->publish(bestPath, bestPathLength);
+            }
+            else if (importExchange && exchange->fetchIfShorter(bestPath, bestPathLength))
             {
-                bestPathLength = pathLength;
-                bestPath = antPath;
+                int worst = static_cast<int>(std::max_element(pathLengths.begin(), pathLengths.end()) - pathLengths.begin());
+                paths[worst] = bestPath;
+                pathLengths[worst] = bestPathLength;
+                noImprovementIterations = 0;
             }
         }
 
-        //     
+        // Обновляем феромоны для всех муравьев
         updatePheromones(paths, pathLengths);
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::PheromoneUpdate)]);
 
-        //  
-        std::cout << " " << iteration << "  : " << bestPathLength << "\n";
+        if (observer)
+            reportProgress(iteration, pathLengths, phaseSeconds, false);
     }
 
-    return bestPath;
+    if (observer)
+        reportProgress(iteration, pathLengths, phaseSeconds, true);
+    result.tour = bestPath;
+    result.length = bestPathLength;
+    result.iterations = iteration;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
 }
-
-
@@ -0,0 +1,99 @@
+﻿#include "ArrayTour.h"
+#include <algorithm>
+
+void ArrayTour::assign(const std::vector<int>& cities)
+{
+    order = cities;
+    positions.resize(order.size());
+    for (int i = 0; i < size(); ++i)
+        positions[order[i]] = i;
+}
+
+bool ArrayTour::between(int a, int b, int c) const
+{
+    int pa = positions[a];
+    int pb = positions[b];
+    int pc = positions[c];
+    if (pa <= pc)
+        return pa <= pb && pb <= pc;
+    return pb >= pa || pb <= pc;
+}
+
+// Инверсия участка от города from до города to (в прямом направлении, с переходом через конец массива)
+void ArrayTour::reverse(int from, int to)
+{
+    const int n = size();
+    int i = positions[from];
+    int j = positions[to];
+    int length = j - i;
+    if (length < 0)
+        length += n;
+    for (int step = (length + 1) / 2; step > 0; --step)
+    {
+        std::swap(order[i], order[j]);
+        positions[order[i]] = i;
+        positions[order[j]] = j;
+        i = i + 1 == n ? 0 : i + 1;
+        j = j == 0 ? n - 1 : j - 1;
+    }
+}
+
+void ArrayTour::twoOptMove(int a, int b, int c, int d)
+{
+    if (next(a) != b)
+    {
+        std::swap(a, b);
+        std::swap(c, d);
+    }
+    int inner = positions[c] - positions[b];
+    if (inner < 0)
+        inner += size();
+    if (2 * (inner + 1) <= size())
+        reverse(b, c);
+    else
+        reverse(d, a);
+}
+
+void ArrayTour::swapSegments(int first, int length1, int length2)
+{
+    const int n = size();
+    const int start = positions[first];
+    buffer.resize(length1 + length2);
+    for (int k = 0; k < length1 + length2; ++k)
+        buffer[k] = order[(start + k) % n];
+    std::rotate(buffer.begin(), buffer.begin() + length1, buffer.end());
+    for (int k = 0; k < length1 + length2; ++k)
+    {
+        int index = (start + k) % n;
+        order[index] = buffer[k];
+        positions[buffer[k]] = index;
+    }
+}
+
+void ActiveQueue::reset(int numCities)
+{
+    queue.resize(numCities);
+    active.assign(numCities, 0);
+    head = 0;
+    count = 0;
+}
+
+void ActiveQueue::push(int city)
+{
+    if (active[city])
+        return;
+    active[city] = 1;
+    int tail = head + count;
+    int size = static_cast<int>(queue.size());
+    queue[tail >= size ? tail - size : tail] = city;
+    ++count;
+}
+
+int ActiveQueue::pop()
+{
+    int city = queue[head];
+    head = head + 1 == static_cast<int>(queue.size()) ? 0 : head + 1;
+    --count;
+    active[city] = 0;
+    return city;
+}
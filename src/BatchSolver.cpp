@@ -0,0 +1,96 @@
+﻿#include "BatchSolver.h"
+#include <algorithm>
+#include <stdexcept>
+
+BatchSolver::BatchSolver(std::vector<SolverConfig> solverConfigs, int threads):
+    configs(std::move(solverConfigs)),
+    pool(std::max(1, threads))
+{
+    for (int i = 0; i < pool.size(); ++i)
+    {
+        workers.emplace_back(new Worker());
+        workers.back()->solvers.resize(configs.size());
+    }
+}
+
+// Следующая задача из собственного диапазона
+bool BatchSolver::takeTask(int worker, int& task)
+{
+    Worker& own = *workers[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin >= own.end)
+        return false;
+    task = own.begin++;
+    return true;
+}
+
+// Перехват второй половины диапазона у первого потока, у которого еще остались задачи
+bool BatchSolver::stealTask(int worker, int& task)
+{
+    const int count = static_cast<int>(workers.size());
+    for (int offset = 1; offset < count; ++offset)
+    {
+        Worker& victim = *workers[(worker + offset) % count];
+        int begin;
+        int end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            int remaining = victim.end - victim.begin;
+            if (remaining <= 0)
+                continue;
+            begin = victim.end - (remaining + 1) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+        Worker& own = *workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        task = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+SolveResult BatchSolver::solveTask(Worker& worker, const BatchTask& task)
+{
+    if (task.config < 0 || task.config >= static_cast<int>(configs.size()))
+        throw std::out_of_range("BatchSolver: неверный номер конфигурации");
+    const SolverConfig& config = configs[task.config];
+
+    std::unique_ptr<TspSolver>& solver = worker.solvers[task.config];
+    if (!solver)
+        solver = config.create(task.instance);
+    else
+        solver->setInstance(task.instance);
+
+    const int size = task.instance.size();
+    if (config.candidates > 0 && size > 1)
+        solver->setCandidateLists(std::make_shared<CandidateLists>(task.instance, std::min(config.candidates, size - 1)));
+    if (config.configure)
+        config.configure(*solver, task.instance);
+    solver->setSeed(task.seed);
+    return solver->solve(config.policy);
+}
+
+std::vector<SolveResult> BatchSolver::solve(const std::vector<BatchTask>& tasks)
+{
+    const int count = static_cast<int>(tasks.size());
+    const int numWorkers = static_cast<int>(workers.size());
+    std::vector<SolveResult> results(count);
+
+    // Начальное разбиение на равные непрерывные диапазоны
+    for (int w = 0; w < numWorkers; ++w)
+    {
+        Worker& worker = *workers[w];
+        worker.begin = static_cast<int>(static_cast<long long>(count) * w / numWorkers);
+        worker.end = static_cast<int>(static_cast<long long>(count) * (w + 1) / numWorkers);
+    }
+
+    pool.run(numWorkers, [&](int w) {
+        int task;
+        while (takeTask(w, task) || stealTask(w, task))
+            results[task] = solveTask(*workers[w], tasks[task]);
+    });
+    return results;
+}
@@ -0,0 +1,71 @@
+﻿#include "CandidateLists.h"
+#include "KdTree.h"
+
+#include <algorithm>
+#include <utility>
+
+CandidateLists::CandidateLists(const TspInstance& instance, int k):
+    numCities(instance.size()),
+    k(std::max(0, std::min(k, instance.size() - 1)))
+{
+    neighbors.resize(static_cast<std::size_t>(numCities) * this->k);
+    if (this->k == 0)
+        return;
+    if (instance.hasCoordinates())
+        buildFromCoordinates(instance);
+    else
+        buildFromMatrix(instance);
+}
+
+void CandidateLists::buildFromCoordinates(const TspInstance& instance)
+{
+    const CoordinateDistances& coordinates = *instance.coordinates();
+    std::vector<double> x(numCities);
+    std::vector<double> y(numCities);
+    for (int i = 0; i < numCities; ++i)
+    {
+        x[i] = coordinates.getX(i);
+        y[i] = coordinates.getY(i);
+    }
+    KdTree tree(x, y);
+
+    // Для GEO порядок по евклидову расстоянию в градусах лишь приближенный:
+    // берем соседей с запасом и пересортировываем по настоящей метрике
+    bool rerank = coordinates.metric() == DistanceMetric::Geo;
+    int query = rerank ? std::min(numCities - 1, 2 * k) : k;
+
+    std::vector<int> found;
+    std::vector<std::pair<double, int>> ranked;
+    for (int city = 0; city < numCities; ++city)
+    {
+        tree.nearest(x[city], y[city], query, city, found);
+        if (rerank)
+        {
+            ranked.clear();
+            for (int other : found)
+                ranked.emplace_back(instance(city, other), other);
+            std::partial_sort(ranked.begin(), ranked.begin() + k, ranked.end());
+            for (int r = 0; r < k; ++r)
+                found[r] = ranked[r].second;
+        }
+        std::copy(found.begin(), found.begin() + k, neighbors.begin() + static_cast<std::size_t>(city) * k);
+    }
+}
+
+void CandidateLists::buildFromMatrix(const TspInstance& instance)
+{
+    std::vector<std::pair<double, int>> row;
+    row.reserve(numCities);
+    for (int city = 0; city < numCities; ++city)
+    {
+        row.clear();
+        for (int other = 0; other < numCities; ++other)
+        {
+            if (other != city)
+                row.emplace_back(instance(city, other), other);
+        }
+        std::partial_sort(row.begin(), row.begin() + k, row.end());
+        for (int r = 0; r < k; ++r)
+            neighbors[static_cast<std::size_t>(city) * k + r] = row[r].second;
+    }
+}
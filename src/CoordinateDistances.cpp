@@ -0,0 +1,95 @@
+﻿#include "CoordinateDistances.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Константы из спецификации TSPLIB
+const double kGeoPi = 3.141592;
+const double kEarthRadius = 6378.388;
+
+// Перевод координаты DDD.MM в радианы
+double geoToRadians(double value)
+{
+    double degrees = static_cast<double>(static_cast<long long>(value));
+    double minutes = value - degrees;
+    return kGeoPi * (degrees + 5.0 * minutes / 3.0) / 180.0;
+}
+
+}
+
+CoordinateDistances::CoordinateDistances(std::vector<double> x, std::vector<double> y,
+                                         DistanceMetric metric, int cacheSlotsPerRow):
+    x(std::move(x)),
+    y(std::move(y)),
+    distanceMetric(metric),
+    cacheSlots(cacheSlotsPerRow)
+{
+    if (this->x.size() != this->y.size())
+        throw std::invalid_argument("CoordinateDistances: разное число координат x и y");
+
+    if (metric == DistanceMetric::Geo)
+    {
+        latitude.resize(this->x.size());
+        longitude.resize(this->x.size());
+        for (std::size_t i = 0; i < this->x.size(); ++i)
+        {
+            latitude[i] = geoToRadians(this->x[i]);
+            longitude[i] = geoToRadians(this->y[i]);
+        }
+    }
+
+    // Кэш имеет смысл только для целочисленных метрик: значение помещается в 32 бита без потерь,
+    // а точное евклидово расстояние дешевле вычислить заново
+    if (metric == DistanceMetric::Euclidean)
+        cacheSlots = 0;
+    if (cacheSlots > 0)
+    {
+        std::size_t total = this->x.size() * static_cast<std::size_t>(cacheSlots);
+        cache.reset(new std::atomic<std::uint64_t>[total]);
+        for (std::size_t k = 0; k < total; ++k)
+            cache[k].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t CoordinateDistances::memoryUsage() const
+{
+    return (x.size() + y.size() + latitude.size() + longitude.size()) * sizeof(double)
+        + x.size() * cacheSlots * sizeof(std::uint64_t);
+}
+
+double CoordinateDistances::geo(int i, int j) const
+{
+    double q1 = std::cos(longitude[i] - longitude[j]);
+    double q2 = std::cos(latitude[i] - latitude[j]);
+    double q3 = std::cos(latitude[i] + latitude[j]);
+    return static_cast<double>(static_cast<long long>(
+        kEarthRadius * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0));
+}
+
+double CoordinateDistances::att(int i, int j) const
+{
+    double dx = x[i] - x[j];
+    double dy = y[i] - y[j];
+    double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+    double t = std::floor(r + 0.5);
+    return t < r ? t + 1.0 : t;
+}
+
+// Поиск в кэше строки i (слот выбирается по j), при промахе - вычисление и запись
+double CoordinateDistances::cached(int i, int j) const
+{
+    if (i > j) // Метрики симметричны, храним пару один раз
+        std::swap(i, j);
+    std::atomic<std::uint64_t>& slot = cache[static_cast<std::size_t>(i) * cacheSlots + j % cacheSlots];
+    std::uint64_t key = static_cast<std::uint64_t>(j) + 1;
+    std::uint64_t entry = slot.load(std::memory_order_relaxed);
+    if ((entry >> 32) == key)
+        return static_cast<double>(static_cast<std::uint32_t>(entry));
+
+    double value = compute(i, j);
+    if (value < 4294967296.0)
+        slot.store((key << 32) | static_cast<std::uint32_t>(value), std::memory_order_relaxed);
+    return value;
+}
@@ -0,0 +1,488 @@
+﻿#include "DecompositionSolver.h"
+#include "KdTree.h"
+#include "LinKernighan.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    const int kMeansIterations = 10;
+    const int kMedoidIterations = 3;
+    const int kRepairCandidates = 8;
+    const int kOrderKicks = 200;  // Возмущения LK в задаче порядка кластеров
+    const int kBlockSize = 4096;  // Городов на одну задачу пула при назначении кластеров
+}
+
+DecompositionSolver::DecompositionSolver(const TspInstance& distances, SolverConfig cluster, int clusterSize, int threads):
+    distances(distances),
+    clusterConfig(std::move(cluster)),
+    clusterSize(std::max(4, clusterSize)),
+    threads(std::max(1, threads)),
+    partition(PartitionMethod::KMeans),
+    repair(true),
+    seed(Random::randomSeed()),
+    pool(std::max(1, threads))
+{
+    if (!clusterConfig.create)
+        throw std::invalid_argument("DecompositionSolver: не задан солвер кластеров");
+}
+
+void DecompositionSolver::setInstance(const TspInstance& instance)
+{
+    distances = instance;
+    candidates.reset();
+    initialTours.clear();
+    exchange.reset();
+}
+
+void DecompositionSolver::setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists)
+{
+    candidates = std::move(candidateLists);
+}
+
+void DecompositionSolver::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+void DecompositionSolver::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
+
+void DecompositionSolver::setPartition(PartitionMethod method)
+{
+    partition = method;
+}
+
+void DecompositionSolver::setRepair(bool enabled)
+{
+    repair = enabled;
+}
+
+double DecompositionSolver::calculatePathLength(const std::vector<int>& path)
+{
+    double length = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+        length += distances(path[i], path[i + 1]);
+    length += distances(path.back(), path[0]);
+    return length;
+}
+
+// Деление городов cities[begin, end) пополам, пока части больше clusterSize: по координатам -
+// по медиане вдоль более длинной стороны, по матрице - по разности расстояний до двух далеких городов
+void DecompositionSolver::splitCluster(std::vector<int>& cities, int begin, int end, std::vector<std::vector<int>>& clusters) const
+{
+    if (end - begin <= clusterSize)
+    {
+        clusters.emplace_back(cities.begin() + begin, cities.begin() + end);
+        return;
+    }
+    const int middle = begin + (end - begin) / 2;
+    if (distances.hasCoordinates())
+    {
+        const CoordinateDistances& points = *distances.coordinates();
+        double minX = std::numeric_limits<double>::max();
+        double maxX = std::numeric_limits<double>::lowest();
+        double minY = minX;
+        double maxY = maxX;
+        for (int k = begin; k < end; ++k)
+        {
+            minX = std::min(minX, points.getX(cities[k]));
+            maxX = std::max(maxX, points.getX(cities[k]));
+            minY = std::min(minY, points.getY(cities[k]));
+            maxY = std::max(maxY, points.getY(cities[k]));
+        }
+        const bool alongX = maxX - minX >= maxY - minY;
+        std::nth_element(cities.begin() + begin, cities.begin() + middle, cities.begin() + end, [&](int a, int b) {
+            return alongX ? points.getX(a) < points.getX(b) : points.getY(a) < points.getY(b);
+        });
+    }
+    else
+    {
+        auto farthest = [&](int from) {
+            int best = cities[begin];
+            for (int k = begin; k < end; ++k)
+                if (distances(from, cities[k]) > distances(from, best))
+                    best = cities[k];
+            return best;
+        };
+        const int a = farthest(cities[begin]);
+        const int b = farthest(a);
+        std::nth_element(cities.begin() + begin, cities.begin() + middle, cities.begin() + end, [&](int u, int v) {
+            return distances(a, u) - distances(b, u) < distances(a, v) - distances(b, v);
+        });
+    }
+    splitCluster(cities, begin, middle, clusters);
+    splitCluster(cities, middle, end, clusters);
+}
+
+// k-средних с ceil(N / clusterSize) центрами; начальные центры - случайные города,
+// ближайший центр ищется kd-деревом
+void DecompositionSolver::kMeans(Random& random, std::vector<std::vector<int>>& clusters)
+{
+    const CoordinateDistances& points = *distances.coordinates();
+    const int n = distances.size();
+    const int k = (n + clusterSize - 1) / clusterSize;
+    std::vector<int> cities(n);
+    std::iota(cities.begin(), cities.end(), 0);
+    std::vector<double> centerX(k);
+    std::vector<double> centerY(k);
+    for (int c = 0; c < k; ++c)
+    {
+        std::swap(cities[c], cities[c + random.below(n - c)]);
+        centerX[c] = points.getX(cities[c]);
+        centerY[c] = points.getY(cities[c]);
+    }
+
+    std::vector<int> assignment(n, -1);
+    const int blocks = (n + kBlockSize - 1) / kBlockSize;
+    std::vector<char> blockChanged(blocks);
+    for (int iteration = 0; iteration < kMeansIterations; ++iteration)
+    {
+        KdTree tree(centerX, centerY);
+        pool.run(blocks, [&](int block) {
+            std::vector<int> nearest;
+            blockChanged[block] = 0;
+            for (int city = block * kBlockSize; city < std::min(n, (block + 1) * kBlockSize); ++city)
+            {
+                tree.nearest(points.getX(city), points.getY(city), 1, -1, nearest);
+                if (assignment[city] != nearest[0])
+                {
+                    assignment[city] = nearest[0];
+                    blockChanged[block] = 1;
+                }
+            }
+        });
+        if (std::find(blockChanged.begin(), blockChanged.end(), 1) == blockChanged.end())
+            break;
+
+        // Пустой кластер сохраняет прежний центр
+        std::vector<double> sumX(k);
+        std::vector<double> sumY(k);
+        std::vector<int> count(k);
+        for (int city = 0; city < n; ++city)
+        {
+            sumX[assignment[city]] += points.getX(city);
+            sumY[assignment[city]] += points.getY(city);
+            ++count[assignment[city]];
+        }
+        for (int c = 0; c < k; ++c)
+        {
+            if (count[c] > 0)
+            {
+                centerX[c] = sumX[c] / count[c];
+                centerY[c] = sumY[c] / count[c];
+            }
+        }
+    }
+
+    std::vector<std::vector<int>> groups(k);
+    for (int city = 0; city < n; ++city)
+        groups[assignment[city]].push_back(city);
+    for (std::vector<int>& group : groups)
+        if (!group.empty())
+            splitCluster(group, 0, static_cast<int>(group.size()), clusters);
+}
+
+// k-медоид: города назначаются ближайшему медоиду, медоид кластера - город с наименьшей
+// суммой расстояний до остальных. Итерация стоит O(N * k + N * clusterSize)
+void DecompositionSolver::kMedoids(Random& random, std::vector<std::vector<int>>& clusters)
+{
+    const int n = distances.size();
+    const int k = (n + clusterSize - 1) / clusterSize;
+    std::vector<int> medoids(n);
+    std::iota(medoids.begin(), medoids.end(), 0);
+    for (int c = 0; c < k; ++c)
+        std::swap(medoids[c], medoids[c + random.below(n - c)]);
+    medoids.resize(k);
+
+    std::vector<int> assignment(n);
+    std::vector<std::vector<int>> groups(k);
+    const int blocks = (n + kBlockSize - 1) / kBlockSize;
+    for (int iteration = 0; iteration < kMedoidIterations; ++iteration)
+    {
+        pool.run(blocks, [&](int block) {
+            for (int city = block * kBlockSize; city < std::min(n, (block + 1) * kBlockSize); ++city)
+            {
+                int best = 0;
+                for (int c = 1; c < k; ++c)
+                    if (distances(city, medoids[c]) < distances(city, medoids[best]))
+                        best = c;
+                assignment[city] = best;
+            }
+        });
+        for (std::vector<int>& group : groups)
+            group.clear();
+        for (int city = 0; city < n; ++city)
+            groups[assignment[city]].push_back(city);
+        if (iteration + 1 == kMedoidIterations)
+            break;
+        pool.run(k, [&](int c) {
+            if (!groups[c].empty())
+                medoids[c] = representative(groups[c]);
+        });
+    }
+
+    for (std::vector<int>& group : groups)
+        if (!group.empty())
+            splitCluster(group, 0, static_cast<int>(group.size()), clusters);
+}
+
+std::vector<std::vector<int>> DecompositionSolver::partitionCities(Random& random)
+{
+    std::vector<std::vector<int>> clusters;
+    const int n = distances.size();
+    if (!distances.hasCoordinates() || partition == PartitionMethod::Medoids)
+    {
+        kMedoids(random, clusters);
+    }
+    else if (partition == PartitionMethod::KMeans)
+    {
+        kMeans(random, clusters);
+    }
+    else
+    {
+        std::vector<int> cities(n);
+        std::iota(cities.begin(), cities.end(), 0);
+        splitCluster(cities, 0, n, clusters);
+    }
+    return clusters;
+}
+
+// Представитель кластера: по координатам - город, ближайший к центру масс, иначе - медоид
+int DecompositionSolver::representative(const std::vector<int>& cluster) const
+{
+    if (distances.hasCoordinates())
+    {
+        const CoordinateDistances& points = *distances.coordinates();
+        double centerX = 0.0;
+        double centerY = 0.0;
+        for (int city : cluster)
+        {
+            centerX += points.getX(city);
+            centerY += points.getY(city);
+        }
+        centerX /= cluster.size();
+        centerY /= cluster.size();
+        auto squared = [&](int city) {
+            double dx = points.getX(city) - centerX;
+            double dy = points.getY(city) - centerY;
+            return dx * dx + dy * dy;
+        };
+        return *std::min_element(cluster.begin(), cluster.end(), [&](int a, int b) { return squared(a) < squared(b); });
+    }
+    int best = cluster[0];
+    double bestSum = std::numeric_limits<double>::max();
+    for (int candidate : cluster)
+    {
+        double sum = 0.0;
+        for (int city : cluster)
+            sum += distances(candidate, city);
+        if (sum < bestSum)
+        {
+            bestSum = sum;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+// Подзадача на городах cities (город i подзадачи - cities[i]) того же типа, что и исходная
+TspInstance DecompositionSolver::subInstance(const std::vector<int>& cities) const
+{
+    const int size = static_cast<int>(cities.size());
+    if (distances.hasCoordinates())
+    {
+        const CoordinateDistances& points = *distances.coordinates();
+        std::vector<double> x(size);
+        std::vector<double> y(size);
+        for (int i = 0; i < size; ++i)
+        {
+            x[i] = points.getX(cities[i]);
+            y[i] = points.getY(cities[i]);
+        }
+        return TspInstance(std::make_shared<CoordinateDistances>(std::move(x), std::move(y), points.metric(), points.cacheSlotsPerRow()));
+    }
+    const DistanceMatrix& matrix = *distances.matrix();
+    const bool triangular = matrix.layout() == DistanceMatrix::Layout::UpperTriangular;
+    auto result = std::make_shared<DistanceMatrix>(size, matrix.precision(), matrix.layout());
+    for (int i = 0; i < size; ++i)
+        for (int j = triangular ? i + 1 : 0; j < size; ++j)
+            result->set(i, j, matrix(cities[i], cities[j]));
+    return TspInstance(result);
+}
+
+// Склейка маршрутов кластеров в порядке order. В каждом цикле удаляется ребро (u, v), для
+// которого меньше всего стоят вход из предыдущего кластера и выход к представителю следующего.
+// В junctions записываются концы вставленных участков
+std::vector<int> DecompositionSolver::stitch(const std::vector<std::vector<int>>& tours, const std::vector<int>& order,
+                                             const std::vector<int>& representatives, std::vector<int>& junctions) const
+{
+    const int count = static_cast<int>(order.size());
+    std::vector<int> tour;
+    tour.reserve(distances.size());
+    if (count == 1)
+        return tours[order[0]];
+
+    int previous = representatives[order.back()];
+    for (int i = 0; i < count; ++i)
+    {
+        const std::vector<int>& cycle = tours[order[i]];
+        const int following = representatives[order[(i + 1) % count]];
+        const int size = static_cast<int>(cycle.size());
+        double bestCost = std::numeric_limits<double>::max();
+        int cut = 0;
+        bool forward = true;
+        for (int j = 0; j < size; ++j)
+        {
+            int u = cycle[j];
+            int v = cycle[j + 1 == size ? 0 : j + 1];
+            double removed = distances(u, v);
+            // Вход в v и обход вперед до u либо вход в u и обход назад до v
+            double forwardCost = distances(previous, v) + distances(u, following) - removed;
+            double backwardCost = distances(previous, u) + distances(v, following) - removed;
+            if (forwardCost < bestCost)
+            {
+                bestCost = forwardCost;
+                cut = j;
+                forward = true;
+            }
+            if (backwardCost < bestCost)
+            {
+                bestCost = backwardCost;
+                cut = j;
+                forward = false;
+            }
+        }
+        junctions.push_back(forward ? cycle[(cut + 1) % size] : cycle[cut]);
+        for (int s = 0; s < size; ++s)
+            tour.push_back(forward ? cycle[(cut + 1 + s) % size] : cycle[(cut - s + size) % size]);
+        junctions.push_back(tour.back());
+        previous = tour.back();
+    }
+    return tour;
+}
+
+std::vector<int> DecompositionSolver::solve()
+{
+    return solve(StopPolicy()).tour;
+}
+
+SolveResult DecompositionSolver::solve(const StopPolicy& policy)
+{
+    StopCondition stop(policy);
+    SolveResult result;
+    Random random(seed);
+    evaluations = 0;
+    double phaseSeconds[kSolverPhaseCount] = {};
+    PhaseTimer timer(observer != nullptr);
+    const int numCities = distances.size();
+    if (numCities == 0) // Пустая задача: разбивать нечего
+    {
+        result.reason = StopReason::IterationLimit;
+        return result;
+    }
+    if (observer)
+        observer->onStart("DC", numCities);
+
+    // Кластеры решаются до общего срока
+    SolverConfig config = clusterConfig;
+    if (policy.timeLimit > std::chrono::steady_clock::duration::zero())
+        config.policy.deadline = std::min(config.policy.deadline, std::chrono::steady_clock::now() + policy.timeLimit);
+    config.policy.deadline = std::min(config.policy.deadline, policy.deadline);
+    if (!config.policy.cancellation)
+        config.policy.cancellation = policy.cancellation;
+
+    std::vector<std::vector<int>> clusters = partitionCities(random);
+    const int count = static_cast<int>(clusters.size());
+    std::vector<int> representatives(count);
+    std::vector<int> clusterOf(numCities);
+    std::vector<BatchTask> tasks;
+    std::vector<int> taskOf(count, -1);
+    for (int c = 0; c < count; ++c)
+    {
+        representatives[c] = representative(clusters[c]);
+        for (int city : clusters[c])
+            clusterOf[city] = c;
+        if (clusters[c].size() >= 4) // Для трех и менее городов все маршруты одинаковы
+        {
+            taskOf[c] = static_cast<int>(tasks.size());
+            tasks.push_back({ subInstance(clusters[c]), 0, random() });
+        }
+    }
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+
+    BatchSolver batch({ config }, threads);
+    std::vector<SolveResult> solved = batch.solve(tasks);
+    tasks.clear();
+    std::vector<std::vector<int>> tours(count);
+    for (int c = 0; c < count; ++c)
+    {
+        if (taskOf[c] < 0)
+        {
+            tours[c] = clusters[c];
+            continue;
+        }
+        SolveResult& part = solved[taskOf[c]];
+        evaluations += part.evaluations;
+        tours[c].resize(part.tour.size());
+        for (size_t i = 0; i < part.tour.size(); ++i)
+            tours[c][i] = clusters[c][part.tour[i]];
+        std::vector<int>().swap(part.tour);
+    }
+
+    // Порядок обхода кластеров - маршрут по их представителям
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    if (count > 3)
+    {
+        LinKernighan orderSolver(subInstance(representatives), kOrderKicks);
+        orderSolver.setSeed(random());
+        order = orderSolver.solve();
+    }
+    std::vector<int> junctions;
+    result.tour = stitch(tours, order, representatives, junctions);
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Decomposition)]);
+    if (observer)
+    {
+        double length = calculatePathLength(result.tour);
+        observer->onProgress({ "DC", count, length, length, -1.0, -1.0, evaluations, phaseSeconds });
+    }
+
+    // Исправление границ: активны стыки и города, у которых есть кандидаты из других кластеров
+    if (repair && count > 1 && numCities >= 5)
+    {
+        std::shared_ptr<const CandidateLists> lists = candidates;
+        if (!lists)
+            lists = std::make_shared<CandidateLists>(distances, std::min(kRepairCandidates, numCities - 1));
+        std::vector<int> active = junctions;
+        for (int city = 0; city < numCities; ++city)
+        {
+            for (const int* it = lists->begin(city); it != lists->end(city); ++it)
+            {
+                if (clusterOf[*it] != clusterOf[city])
+                {
+                    active.push_back(city);
+                    break;
+                }
+            }
+        }
+        LocalSearch localSearch(distances, lists);
+        LocalSearch::Workspace workspace;
+        localSearch.improve(result.tour, active, workspace);
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+    }
+
+    result.length = calculatePathLength(result.tour);
+    StopReason reason = stop.interrupted();
+    result.reason = reason != StopReason::None ? reason : StopReason::IterationLimit;
+    result.iterations = count;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    if (observer)
+        observer->onFinish({ "DC", count, result.length, result.length, -1.0, -1.0, evaluations, phaseSeconds });
+    return result;
+}
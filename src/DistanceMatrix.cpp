@@ -0,0 +1,105 @@
+﻿#include "DistanceMatrix.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const std::size_t kAlignment = 64; // Размер строки кэша
+
+// Выделение памяти, выровненной по границе строки кэша
+void* alignedAllocate(std::size_t bytes)
+{
+    void* raw = std::malloc(bytes + kAlignment + sizeof(void*));
+    if (!raw)
+        throw std::bad_alloc();
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    std::uintptr_t aligned = (start + kAlignment - 1) & ~static_cast<std::uintptr_t>(kAlignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void alignedFree(void* p)
+{
+    if (p)
+        std::free(static_cast<void**>(p)[-1]);
+}
+
+}
+
+DistanceMatrix::DistanceMatrix(int size, Precision precision, Layout layout):
+    n(size),
+    valuePrecision(precision),
+    valueLayout(layout)
+{
+    allocate();
+}
+
+DistanceMatrix::DistanceMatrix(const std::vector<std::vector<double>>& matrix, Precision precision, Layout layout):
+    n(static_cast<int>(matrix.size())),
+    valuePrecision(precision),
+    valueLayout(layout)
+{
+    allocate();
+    for (int i = 0; i < n; ++i)
+    {
+        if (static_cast<int>(matrix[i].size()) != n)
+            throw std::invalid_argument("DistanceMatrix: матрица должна быть квадратной");
+        for (int j = (layout == Layout::Full ? 0 : i + 1); j < n; ++j)
+            set(i, j, matrix[i][j]);
+    }
+}
+
+DistanceMatrix::DistanceMatrix(int size, Precision precision, Layout layout, std::shared_ptr<void> storage, void* data):
+    n(size),
+    valuePrecision(precision),
+    valueLayout(layout),
+    storage(std::move(storage)),
+    data(data)
+{
+    std::size_t cities = static_cast<std::size_t>(size);
+    count = layout == Layout::Full ? cities * cities : cities * (cities - (cities > 0 ? 1 : 0)) / 2;
+}
+
+void DistanceMatrix::allocate()
+{
+    if (n < 0)
+        throw std::invalid_argument("DistanceMatrix: отрицательный размер");
+    std::size_t size = static_cast<std::size_t>(n);
+    count = valueLayout == Layout::Full ? size * size : size * (size - (size > 0 ? 1 : 0)) / 2;
+    std::size_t bytes = count * elementSize();
+    data = alignedAllocate(bytes);
+    storage = std::shared_ptr<void>(data, alignedFree);
+    std::memset(data, 0, bytes);
+}
+
+// Запись расстояния; в упакованном режиме (i, j) и (j, i) - одна ячейка
+void DistanceMatrix::set(int i, int j, double value)
+{
+    if (valueLayout == Layout::UpperTriangular)
+    {
+        if (i == j)
+            return;
+        if (i > j)
+            std::swap(i, j);
+    }
+    std::size_t k = index(i, j);
+    if (valuePrecision == Precision::Double)
+        static_cast<double*>(data)[k] = value;
+    else if (valuePrecision == Precision::Float)
+        static_cast<float*>(data)[k] = static_cast<float>(value);
+    else
+        static_cast<std::int32_t*>(data)[k] = static_cast<std::int32_t>(std::lround(value));
+}
+
+std::vector<std::vector<double>> DistanceMatrix::toVector() const
+{
+    std::vector<std::vector<double>> result(n, std::vector<double>(n));
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            result[i][j] = (*this)(i, j);
+    return result;
+}
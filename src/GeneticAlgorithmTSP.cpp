@@ -3,208 +3,644 @@
 GeneticAlgorithm::GeneticAlgorithm(const std::vector<std::vector<double>>& distanceMatrix,
     int populationSize, int generations,
     double mutationRate, double crossoverRate, int tournamentSize): 
-    distanceMatrix(distanceMatrix),
-    numCities(distanceMatrix.size()),
+    GeneticAlgorithm(TspInstance(distanceMatrix), populationSize, generations,
+                     mutationRate, crossoverRate, tournamentSize) {}
+
+GeneticAlgorithm::GeneticAlgorithm(const TspInstance& distances,
+    int populationSize, int generations,
+    double mutationRate, double crossoverRate, int tournamentSize): 
+    numCities(distances.size()),
     populationSize(populationSize),
     generations(generations),
     mutationRate(mutationRate),
     crossoverRate(crossoverRate),
-    tournamentSize(tournamentSize) {}
+    tournamentSize(tournamentSize),
+    distances(distances),
+    seed(Random::randomSeed()),
+    numThreads(1),
+    localSearchRate(1.0),
+    constructionRate(1.0),
+    numIslands(1),
+    migrationInterval(50),
+    numMigrants(2),
+    topology(MigrationTopology::Ring) {}
 
-// Инициализация начальной популяции, состоящей из populationSize хромосом
-std::vector<GeneticAlgorithm::Individual> GeneticAlgorithm::initializePopulation() 
+// Новая задача для того же объекта; буферы популяций и потоки переиспользуются
+void GeneticAlgorithm::setInstance(const TspInstance& instance)
 {
-    std::vector<Individual> population;
-    std::vector<int> initialPath(numCities);
+    distances = instance;
+    numCities = instance.size();
+    localSearch.reset();
+    construction.reset();
+    initialTours.clear();
+    exchange.reset();
+}
 
-    for (int i = 0; i < numCities; ++i) 
-    {
-        initialPath[i] = i;
-    }
+template <>
+GeneticAlgorithm::Population<std::uint16_t>* GeneticAlgorithm::populationBuffers<std::uint16_t>()
+{
+    return populations16;
+}
+
+template <>
+GeneticAlgorithm::Population<std::uint32_t>* GeneticAlgorithm::populationBuffers<std::uint32_t>()
+{
+    return populations32;
+}
+
+// Зерно генератора: при одинаковых зерне и числе потоков результат повторяется
+void GeneticAlgorithm::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+// Параллельное построение поколений на пуле из threads потоков
+void GeneticAlgorithm::setThreads(int threads)
+{
+    numThreads = std::max(1, threads);
+    threadPool.reset(numThreads > 1 ? new ThreadPool(numThreads) : nullptr);
+}
 
-    // Перестановки случайным образом
-    for (int i = 0; i < populationSize; ++i) 
+// Наблюдатель получает прогресс после каждого поколения; без него ничего не печатается
+void GeneticAlgorithm::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
+
+// Меметический режим: доля rate потомков (и особей начальной популяции) доводится
+// локальным поиском до локального оптимума перед оценкой приспособленности
+void GeneticAlgorithm::setLocalSearch(std::shared_ptr<const LocalSearch> newLocalSearch, double rate)
+{
+    localSearch = std::move(newLocalSearch);
+    localSearchRate = std::max(0.0, std::min(1.0, rate));
+}
+
+// Доля rate особей начальной популяции строится эвристикой вместо случайной перестановки.
+// Для разнообразия популяции подходит ближайший сосед со случайным стартом и setNoise > 1:
+// детерминированные методы дают одинаковые особи
+void GeneticAlgorithm::setConstruction(std::shared_ptr<const TourConstruction> newConstruction, double rate)
+{
+    construction = std::move(newConstruction);
+    constructionRate = std::max(0.0, std::min(1.0, rate));
+}
+
+// Островная модель: islands популяций развиваются параллельно (по потоку на остров)
+// и каждые interval поколений обмениваются migrants лучшими особями.
+// Обмен асинхронный, поэтому в этом режиме результат зависит от планирования потоков
+void GeneticAlgorithm::setIslands(int islands, int interval, int migrants, MigrationTopology migrationTopology)
+{
+    numIslands = std::max(1, islands);
+    migrationInterval = std::max(1, interval);
+    numMigrants = std::max(0, std::min(migrants, populationSize / 2));
+    topology = migrationTopology;
+}
+
+// Выполнение task(block) для блоков [0, blocks) на пуле потоков либо последовательно.
+// Задача передается по ссылке, чтобы std::function не выделял память на каждое поколение
+template <typename Task>
+void GeneticAlgorithm::runBlocks(int blocks, const Task& task)
+{
+    if (threadPool)
+        threadPool->run(blocks, std::cref(task));
+    else
+        for (int block = 0; block < blocks; ++block)
+            task(block);
+}
+
+// Инициализация особей [begin, end) начальной популяции случайными перестановками или
+// построенными эвристикой (см. setConstruction). Первые особи популяции (на каждом острове) -
+// маршруты теплого старта, если они заданы
+template <typename Gene>
+void GeneticAlgorithm::initializePopulation(Population<Gene>& population, Workspace& workspace, int begin, int end) 
+{
+    for (int i = begin; i < end; ++i) 
     {
-        std::random_shuffle(initialPath.begin(), initialPath.end());
-        Individual indiv = { initialPath, 1.0 / calculatePathLength(initialPath) };
-        population.push_back(indiv);
+        Gene* path = population.path(i, numCities);
+        if (i < static_cast<int>(initialTours.size()))
+        {
+            std::copy(initialTours[i].begin(), initialTours[i].end(), path);
+        }
+        else if (construction && workspace.random.uniform() < constructionRate)
+        {
+            construction->build(workspace.tour, workspace.random);
+            std::copy(workspace.tour.begin(), workspace.tour.end(), path);
+        }
+        else
+        {
+            for (int city = 0; city < numCities; ++city) 
+            {
+                path[city] = static_cast<Gene>(city);
+            }
+            std::shuffle(path, path + numCities, workspace.random);
+        }
+        if (localSearch && workspace.random.uniform() < localSearchRate)
+            improve(path, workspace);
+        population.fitness[i] = 1.0 / pathLength(path);
     }
+}
 
-    return population;
+// Локальный поиск над маршрутом особи
+template <typename Gene>
+void GeneticAlgorithm::improve(Gene* path, Workspace& workspace)
+{
+    workspace.tour.assign(path, path + numCities);
+    localSearch->improve(workspace.tour, workspace.localSearch);
+    std::copy(workspace.tour.begin(), workspace.tour.end(), path);
 }
 
 // Вычисление длины маршрута
 double GeneticAlgorithm::calculatePathLength(const std::vector<int>& path) 
+{
+    return pathLength(path.data());
+}
+
+template <typename Gene>
+double GeneticAlgorithm::pathLength(const Gene* path) const
 {
     double length = 0;
-    for (int i = 0; i != path.size() - 1; ++i) 
+    for (int i = 0; i != numCities - 1; ++i) 
     {
-        length += distanceMatrix[path[i]][path[i + 1]];
+        length += distances(path[i], path[i + 1]);
     }
-    length += distanceMatrix[path.back()][path[0]]; 
+    length += distances(path[numCities - 1], path[0]); 
     return length;
 }
 
-// Оценка приспособленности для каждого индивидуума в поколении
-void GeneticAlgorithm::evaluateFitness(std::vector<Individual>& population) 
-{
-    for (auto& indiv : population)
-        indiv.fitness = 1.0 / calculatePathLength(indiv.path); // Значение целевой функции обратно пропорционально длине маршрута
-}
-
-// Поиск лучшей особи в популяции
-GeneticAlgorithm::Individual GeneticAlgorithm::bestIndividual(const std::vector<Individual>& population) 
+// Поиск лучшей особи в популяции (возвращается ее номер)
+template <typename Gene>
+int GeneticAlgorithm::bestIndividual(const Population<Gene>& population) const
 {
-    Individual best = population[0];
-    for (int i = 1; i != population.size(); ++i) 
+    int best = 0;
+    for (int i = 1; i != populationSize; ++i) 
     {
-        if (population[i].fitness > best.fitness)
-            best = population[i];
+        if (population.fitness[i] > population.fitness[best])
+            best = i;
     }
     return best;
 }
 
-// Турнирная селекция
-std::vector<GeneticAlgorithm::Individual> GeneticAlgorithm::selection(const std::vector<Individual>& population) 
+// Турнирная селекция одного родителя (возвращается его номер)
+template <typename Gene>
+int GeneticAlgorithm::selection(const Population<Gene>& population, Random& random) const
 {
-    std::vector<Individual> selected;
-    for (int i = 0; i != populationSize; ++i) 
+    // Случайным образом выбираем участников турнира и находим лучшего из них
+    int best = random.below(populationSize);
+    for (int j = 1; j < tournamentSize; ++j) 
     {
-        std::vector<Individual> tournament;
-
-        // Случайным образом выбираем участников турнира
-        for (int j = 0; j != tournamentSize; ++j) {
-            int index = rand() % populationSize;
-            tournament.push_back(population[index]);
-        }
-
-        // Находим лучшего индивидуума в турнире
-        Individual best = *std::max_element(tournament.begin(), tournament.end(), [](const Individual& a, const Individual& b) {
-            return a.fitness < b.fitness;
-            });
-
-        selected.push_back(best); // Добавляем лучшего из турнира в список отобранных
+        int index = random.below(populationSize);
+        if (population.fitness[index] > population.fitness[best])
+            best = index;
     }
-    return selected;
+    return best;
 }
 
 // Скрещивание OX-методом
-std::vector<GeneticAlgorithm::Individual> GeneticAlgorithm::crossover(const Individual& parent1, const Individual& parent2) 
+template <typename Gene>
+void GeneticAlgorithm::crossover(const Gene* parent1, const Gene* parent2, Gene* child1, Gene* child2, Workspace& workspace) 
 {
-    std::vector<Individual> children;
-    if ((double)rand() / RAND_MAX < crossoverRate) { // Скрещивание происходит с вероятностью crossoverRate
+    if (workspace.random.uniform() < crossoverRate) { // Скрещивание происходит с вероятностью crossoverRate
         // Выбираем 2 точки разбиения
-        int point1 = rand() % numCities;
-        int point2 = rand() % numCities;
+        int point1 = workspace.random.below(numCities);
+        int point2 = workspace.random.below(numCities);
         if (point1 > point2) std::swap(point1, point2);
 
         // Создаем потомков
-        children.push_back(crossoverHelper(parent1, parent2, point1, point2));
+        crossoverHelper(parent1, parent2, point1, point2, child1, workspace);
         // Меняем родителей местами 
-        children.push_back(crossoverHelper(parent2, parent1, point1, point2));
+        if (child2)
+            crossoverHelper(parent2, parent1, point1, point2, child2, workspace);
     }
     else {
-        children.push_back(parent1);
-        children.push_back(parent2);
+        std::copy(parent1, parent1 + numCities, child1);
+        if (child2)
+            std::copy(parent2, parent2 + numCities, child2);
     }
-    return children;
 }
 
 // Функция, содержащая основную логику скрещивания
-GeneticAlgorithm::Individual GeneticAlgorithm::crossoverHelper(const Individual& parent1, const Individual& parent2, int point1, int point2)
+template <typename Gene>
+void GeneticAlgorithm::crossoverHelper(const Gene* parent1, const Gene* parent2, int point1, int point2,
+                                       Gene* child, Workspace& workspace)
 {
-    std::vector<int> child(numCities, -1);
+    // Новая метка вместо очистки массива; при переполнении счетчика массив сбрасывается
+    if (++workspace.stamp == 0)
+    {
+        std::fill(workspace.mark.begin(), workspace.mark.end(), 0);
+        workspace.stamp = 1;
+    }
+    const std::uint32_t stamp = workspace.stamp;
+    std::uint32_t* mark = workspace.mark.data();
 
     // Копируем сегмент из parent1
-    std::unordered_set<int> segment;
     for (int i = point1; i <= point2; ++i) 
     {
-        child[i] = parent1.path[i];
-        segment.insert(parent1.path[i]);
+        child[i] = parent1[i];
+        mark[parent1[i]] = stamp;
     }
 
     // Заполняем остальное из parent2, пропуская дубликаты
-    int pos = (point2 + 1) % numCities;
+    int pos = point2 + 1 == numCities ? 0 : point2 + 1;
+    int source = pos;
     for (int i = 0; i < numCities; ++i) 
     {
-        int city = parent2.path[(point2 + 1 + i) % numCities];
-        if (segment.count(city) == 0) 
+        Gene city = parent2[source];
+        if (++source == numCities)
+            source = 0;
+        if (mark[city] != stamp) 
         {
             child[pos] = city;
-            pos = (pos + 1) % numCities;
+            if (++pos == numCities)
+                pos = 0;
         }
     }
-
-    return { child, -1 };
 }
 
 // Мутация путем инверсии подпоследовательности
-void GeneticAlgorithm::mutate(Individual& indiv) 
+template <typename Gene>
+void GeneticAlgorithm::mutate(Gene* path, Random& random) 
 {
-    if ((double)rand() / RAND_MAX < mutationRate) // Мутация происходит с вероятностью mutationRate
+    if (random.uniform() < mutationRate) // Мутация происходит с вероятностью mutationRate
     {
-        int i = rand() % numCities;
-        int j = rand() % numCities;
+        int i = random.below(numCities);
+        int j = random.below(numCities);
         if (i > j) std::swap(i, j);
-        std::reverse(indiv.path.begin() + i, indiv.path.begin() + j + 1);
+        std::reverse(path + i, path + j + 1);
     }
 }
 
-// Вывод отладочной информации
-void GeneticAlgorithm::printBestSolution(int generation, const Individual& best) 
+// Передача состояния наблюдателю. Время фаз суммируется по блокам [workspaceBegin, workspaceEnd)
+template <typename Gene>
+void GeneticAlgorithm::reportProgress(int generation, const Population<Gene>& population, int bestIndex,
+                                      double bestFitness, int workspaceBegin, int workspaceEnd, bool finished)
 {
-    std::cout << "Поколение " << generation << " Лучший путь: " << 1.0 / best.fitness << std::endl;
+    if (!observer)
+        return;
+
+    // Разнообразие - коэффициент вариации длин маршрутов в поколении
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (int i = 0; i < populationSize; ++i)
+    {
+        double length = 1.0 / population.fitness[i];
+        sum += length;
+        sumSquares += length * length;
+    }
+    double mean = sum / populationSize;
+    double variance = std::max(0.0, sumSquares / populationSize - mean * mean);
+
+    double phaseSeconds[kSolverPhaseCount] = {};
+    for (int w = workspaceBegin; w < workspaceEnd; ++w)
+        for (int phase = 0; phase < kSolverPhaseCount; ++phase)
+            phaseSeconds[phase] += workspaces[w].phaseSeconds[phase];
+
+    SolverProgress progress = { "GA", generation, 1.0 / bestFitness, 1.0 / population.fitness[bestIndex], -1.0,
+                                mean > 0.0 ? std::sqrt(variance) / mean : 0.0, evaluations.load(), phaseSeconds };
+    if (finished)
+        observer->onFinish(progress);
+    else
+        observer->onProgress(progress);
 }
 
-// Запуск генетического алгоритма
-std::vector<int> GeneticAlgorithm::solve() 
+// Построение пар [pairBegin, pairEnd) новой популяции: селекция, скрещивание, мутация и оценка.
+// Блоки не пересекаются и используют свои потоки генератора, поэтому выполняются параллельно
+template <typename Gene>
+void GeneticAlgorithm::breed(const Population<Gene>& population, Population<Gene>& newPopulation,
+                             Workspace& workspace, int pairBegin, int pairEnd)
 {
-    std::vector<Individual> population = initializePopulation(); // Задаем начальную популяцию 
-    Individual best = bestIndividual(population);
-    printBestSolution(0, best);
+    PhaseTimer timer(observer != nullptr);
+    double* phaseSeconds = workspace.phaseSeconds;
+    for (int pair = pairBegin; pair < pairEnd; ++pair) 
+    {
+        int parent1 = selection(population, workspace.random); // Селекция
+        int parent2 = selection(population, workspace.random);
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Selection)]);
+        int child1 = 2 * pair;
+        int child2 = child1 + 1 < populationSize ? child1 + 1 : -1;
+
+        // Потомки записываются сразу на свои места в новой популяции
+        crossover(population.path(parent1, numCities), population.path(parent2, numCities),
+                  newPopulation.path(child1, numCities), child2 >= 0 ? newPopulation.path(child2, numCities) : nullptr,
+                  workspace); // Попарное скрещивание отобранных особей
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Crossover)]);
+        for (int child : { child1, child2 }) 
+        {
+            if (child < 0)
+                continue;
+            Gene* path = newPopulation.path(child, numCities);
+            mutate(path, workspace.random); // Мутации
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Mutation)]);
+            if (localSearch && workspace.random.uniform() < localSearchRate)
+            {
+                improve(path, workspace);
+                timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+            }
+            newPopulation.fitness[child] = 1.0 / pathLength(path); // Оценка приспособленности особи нового поколения
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Evaluation)]);
+        }
+    }
+}
+
+// Обмен с другими солверами портфеля: лучшая особь публикуется, а более короткий общий маршрут
+// заменяет худшую особь популяции (как элита) и становится лучшим найденным; тогда возвращается true
+template <typename Gene>
+bool GeneticAlgorithm::shareBest(Population<Gene>& population, std::vector<Gene>& best, double& bestFitness)
+{
+    double length = 1.0 / bestFitness;
+    if (length < exchange->bestLength())
+    {
+        exchange->publish(std::vector<int>(best.begin(), best.end()), length);
+        return false;
+    }
+    std::vector<int> shared;
+    if (!importExchange || !exchange->fetchIfShorter(shared, length))
+        return false;
+    int worst = static_cast<int>(std::min_element(population.fitness.begin(), population.fitness.end()) - population.fitness.begin());
+    Gene* path = population.path(worst, numCities);
+    std::copy(shared.begin(), shared.end(), path);
+    population.fitness[worst] = 1.0 / length;
+    best.assign(path, path + numCities);
+    bestFitness = 1.0 / length;
+    return true;
+}
+
+// Основной цикл для выбранного типа гена. Все буферы выделяются до первого поколения
+// (и сохраняются для следующих запусков), дальше популяции только меняются местами
+template <typename Gene>
+SolveResult GeneticAlgorithm::run(const StopCondition& stop)
+{
+    const int blocks = static_cast<int>(workspaces.size());
+    const size_t genesCount = static_cast<size_t>(populationSize) * numCities;
+    Population<Gene>& population = populationBuffers<Gene>()[0];
+    Population<Gene>& newPopulation = populationBuffers<Gene>()[1];
+    population.genes.resize(genesCount);
+    population.fitness.resize(populationSize);
+    newPopulation.genes.resize(genesCount);
+    newPopulation.fitness.resize(populationSize);
+
+    // Задаем начальную популяцию, каждый блок - своим потоком генератора
+    auto initializeBlock = [&](int block) {
+        PhaseTimer timer(observer != nullptr);
+        initializePopulation(population, workspaces[block], populationSize * block / blocks, populationSize * (block + 1) / blocks);
+        timer.lap(workspaces[block].phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+    };
+    runBlocks(blocks, initializeBlock);
+    evaluations += populationSize;
+    int bestIndex = bestIndividual(population);
+    std::vector<Gene> best(population.path(bestIndex, numCities), population.path(bestIndex, numCities) + numCities);
+    double bestFitness = population.fitness[bestIndex];
+    reportProgress(0, population, bestIndex, bestFitness, 0, blocks, false);
+
+    const int numPairs = (populationSize + 1) / 2; // При нечетном размере последняя пара дает одного потомка
+    auto breedBlock = [&](int block) {
+        breed(population, newPopulation, workspaces[block], numPairs * block / blocks, numPairs * (block + 1) / blocks);
+    };
 
     int noImprovementGenerations = 0; // Счетчик поколений без улучшения
+    SolveResult result;
+    result.reason = StopReason::IterationLimit;
     for (int generation = 1; generation <= generations; ++generation) 
     {
-        std::vector<Individual> selected = selection(population); // Селекция
+        StopReason reason = stop.check(1.0 / bestFitness, evaluations, noImprovementGenerations);
+        if (reason != StopReason::None)
+        {
+            result.reason = reason;
+            break;
+        }
+        result.iterations = generation;
 
         // Создание новой популяции
-        std::vector<Individual> newPopulation;
-        for (int i = 0; i < selected.size() - 1; i += 2) 
+        runBlocks(blocks, breedBlock);
+        evaluations += populationSize;
+
+        std::swap(population.genes, newPopulation.genes); // Обновляем популяцию
+        std::swap(population.fitness, newPopulation.fitness);
+        bestIndex = bestIndividual(population); // Находим лучшую особь в новом поколении
+
+        if (population.fitness[bestIndex] > bestFitness) 
+        {
+            bestFitness = population.fitness[bestIndex];
+            std::copy(population.path(bestIndex, numCities), population.path(bestIndex, numCities) + numCities, best.begin());
+            noImprovementGenerations = 0;
+        }
+        else
         {
-            std::vector<Individual> children = crossover(selected[i], selected[i + 1]); // Попарное скрещивание отобранных особей
-            mutate(children[0]);
-            mutate(children[1]); // Мутации
-            newPopulation.push_back(children[0]);
-            newPopulation.push_back(children[1]); // Добавление полученных потомков в новую популяцию
+            ++noImprovementGenerations;
         }
+        if (exchange && shareBest(population, best, bestFitness))
+            noImprovementGenerations = 0;
+
+        reportProgress(generation, population, bestIndex, bestFitness, 0, blocks, false); // Сообщаем о текущем поколении
+    }
+    reportProgress(result.iterations, population, bestIndex, bestFitness, 0, blocks, true);
+    result.tour.assign(best.begin(), best.end());
+    result.length = 1.0 / bestFitness;
+    return result;
+}
+
+// Обмен с другими островами: прием мигрантов на место худших особей и отправка лучших.
+// order - заранее выделенный массив номеров особей
+template <typename Gene>
+void GeneticAlgorithm::migrate(int island, Population<Gene>& population, std::vector<int>& order,
+                               std::vector<Mailbox<Gene>>& mailboxes)
+{
+    for (int i = 0; i < populationSize; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return population.fitness[a] > population.fitness[b]; });
+
+    // Прием: если ящик занят отправителем, обмен пропускается до следующего раза
+    Mailbox<Gene>& inbox = mailboxes[island];
+    std::unique_lock<std::mutex> inboxLock(inbox.mutex, std::try_to_lock);
+    if (inboxLock.owns_lock() && inbox.fresh)
+    {
+        for (int m = 0; m < numMigrants; ++m)
+        {
+            int worst = order[populationSize - 1 - m];
+            std::copy(inbox.genes.begin() + static_cast<size_t>(m) * numCities,
+                      inbox.genes.begin() + static_cast<size_t>(m + 1) * numCities, population.path(worst, numCities));
+            population.fitness[worst] = inbox.fitness[m];
+        }
+        inbox.fresh = false;
+    }
+    if (inboxLock.owns_lock())
+        inboxLock.unlock();
+
+    // Отправка лучших особей соседу
+    int target = (island + 1) % numIslands;
+    if (topology == MigrationTopology::Random)
+    {
+        target = workspaces[island].random.below(numIslands - 1);
+        if (target >= island)
+            ++target;
+    }
+    Mailbox<Gene>& outbox = mailboxes[target];
+    std::lock_guard<std::mutex> outboxLock(outbox.mutex);
+    for (int m = 0; m < numMigrants; ++m)
+    {
+        const Gene* path = population.path(order[m], numCities);
+        std::copy(path, path + numCities, outbox.genes.begin() + static_cast<size_t>(m) * numCities);
+        outbox.fitness[m] = population.fitness[order[m]];
+    }
+    outbox.fresh = true;
+}
+
+// Эволюция одного острова в своем потоке
+template <typename Gene>
+void GeneticAlgorithm::evolveIsland(int island, std::vector<Mailbox<Gene>>& mailboxes, IslandState<Gene>& state,
+                                    const StopCondition& stop, std::atomic<StopReason>& globalStop)
+{
+    std::vector<Gene>& best = state.best;
+    double& bestFitness = state.bestFitness;
+    Workspace& workspace = workspaces[island];
+    const size_t genesCount = static_cast<size_t>(populationSize) * numCities;
+    const int numPairs = (populationSize + 1) / 2;
+    Population<Gene> population;
+    Population<Gene> newPopulation;
+    population.genes.resize(genesCount);
+    population.fitness.resize(populationSize);
+    newPopulation.genes.resize(genesCount);
+    newPopulation.fitness.resize(populationSize);
+    std::vector<int> order(populationSize);
+
+    PhaseTimer timer(observer != nullptr);
+    initializePopulation(population, workspace, 0, populationSize);
+    timer.lap(workspace.phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+    evaluations += populationSize;
+    int bestIndex = bestIndividual(population);
+    best.assign(population.path(bestIndex, numCities), population.path(bestIndex, numCities) + numCities);
+    bestFitness = population.fitness[bestIndex];
 
-        if (populationSize % 2 == 1) // Если размер популяции нечетный, то добавить еще одного потомка в новую популяцию
+    int noImprovementGenerations = 0;
+    state.reason = StopReason::IterationLimit;
+    for (int generation = 1; generation <= generations; ++generation) 
+    {
+        // Остановка по сроку, цели, отмене или числу оценок действует на все острова,
+        // застой - только на текущий
+        StopReason reason = globalStop.load();
+        if (reason == StopReason::None)
+            reason = stop.check(1.0 / bestFitness, evaluations, 0);
+        if (reason != StopReason::None)
         {
-            std::vector<Individual> children = crossover(selected[0], selected.back());
-            mutate(children[0]);
-            newPopulation.push_back(children[0]);
+            StopReason expected = StopReason::None;
+            globalStop.compare_exchange_strong(expected, reason);
+            state.reason = globalStop.load();
+            break;
         }
+        if (stop.stalled(noImprovementGenerations))
+        {
+            state.reason = StopReason::Stalled;
+            break;
+        }
+        state.generations = generation;
 
-        evaluateFitness(newPopulation); // Оценка приспособленности особей нового поколения
+        breed(population, newPopulation, workspace, 0, numPairs);
+        evaluations += populationSize;
+        std::swap(population.genes, newPopulation.genes);
+        std::swap(population.fitness, newPopulation.fitness);
 
-        population = newPopulation; // Обновляем популяцию
-        Individual newBest = bestIndividual(population); // Находим лучшую особь в новом поколении
+        if (numMigrants > 0 && generation % migrationInterval == 0)
+            migrate(island, population, order, mailboxes);
 
-        if (newBest.fitness > best.fitness) 
+        bestIndex = bestIndividual(population);
+        if (population.fitness[bestIndex] > bestFitness) 
         {
-            best = newBest;
+            bestFitness = population.fitness[bestIndex];
+            std::copy(population.path(bestIndex, numCities), population.path(bestIndex, numCities) + numCities, best.begin());
             noImprovementGenerations = 0;
         }
         else
         {
             ++noImprovementGenerations;
         }
+        if (exchange && shareBest(population, best, bestFitness))
+            noImprovementGenerations = 0;
 
-        printBestSolution(generation, best); // Выводим решение для текущего поколения
+        if (island == 0) // Прогресс сообщает только первый остров (время фаз - тоже только его)
+            reportProgress(generation, population, bestIndex, bestFitness, 0, 1, false);
+    }
+}
 
-        if (noImprovementGenerations >= 100) // Если 100 поколений не было улучшений, то алгоритм завершает работу
-            break;
+// Запуск островной модели: по потоку на остров, результат - лучшая особь среди всех островов
+template <typename Gene>
+SolveResult GeneticAlgorithm::runIslands(const StopCondition& stop)
+{
+    std::vector<Mailbox<Gene>> mailboxes(numIslands);
+    for (Mailbox<Gene>& mailbox : mailboxes)
+    {
+        mailbox.genes.resize(static_cast<size_t>(numMigrants) * numCities);
+        mailbox.fitness.resize(numMigrants);
     }
-    return best.path;
+    std::vector<IslandState<Gene>> states(numIslands);
+    std::atomic<StopReason> globalStop{ StopReason::None };
+
+    ThreadPool islandPool(numIslands);
+    islandPool.run(numIslands, [&](int island) { evolveIsland(island, mailboxes, states[island], stop, globalStop); });
+
+    SolveResult result;
+    int winner = 0;
+    bool allStalled = true;
+    for (int island = 0; island < numIslands; ++island)
+    {
+        if (states[island].bestFitness > states[winner].bestFitness)
+            winner = island;
+        result.iterations = std::max(result.iterations, states[island].generations);
+        allStalled = allStalled && states[island].reason == StopReason::Stalled;
+    }
+    result.reason = globalStop.load();
+    if (result.reason == StopReason::None)
+        result.reason = allStalled ? StopReason::Stalled : StopReason::IterationLimit;
+    result.tour.assign(states[winner].best.begin(), states[winner].best.end());
+    result.length = 1.0 / states[winner].bestFitness;
+
+    if (observer)
+    {
+        // Итог по всем островам; время фаз суммируется по всем островам
+        double phaseSeconds[kSolverPhaseCount] = {};
+        for (const Workspace& workspace : workspaces)
+            for (int phase = 0; phase < kSolverPhaseCount; ++phase)
+                phaseSeconds[phase] += workspace.phaseSeconds[phase];
+        SolverProgress progress = { "GA", result.iterations, result.length, result.length, -1.0, -1.0,
+                                    evaluations.load(), phaseSeconds };
+        observer->onFinish(progress);
+    }
+    return result;
+}
+
+// Запуск генетического алгоритма: останавливается, если 100 поколений подряд не было улучшений
+std::vector<int> GeneticAlgorithm::solve() 
+{
+    StopPolicy policy;
+    policy.stallIterations = 100;
+    return solve(policy).tour;
+}
+
+// Запуск с условиями остановки; возвращает лучший маршрут, найденный к моменту остановки
+SolveResult GeneticAlgorithm::solve(const StopPolicy& policy)
+{
+    checkInitialTours(numCities);
+    StopCondition stop(policy);
+    // Каждый блок поколения (в островной модели - каждый остров) использует свой поток генератора,
+    // полученный из общего зерна. Разбиение на блоки фиксировано, поэтому без островов
+    // результат не зависит от планирования потоков
+    const int blocks = numIslands > 1 ? numIslands : std::max(1, std::min(numThreads, (populationSize + 1) / 2));
+    Random master(seed);
+    evaluations = 0;
+    workspaces.resize(blocks);
+    for (Workspace& workspace : workspaces)
+    {
+        workspace.random = master.split();
+        workspace.mark.assign(numCities, 0);
+        workspace.stamp = 0;
+        std::fill(std::begin(workspace.phaseSeconds), std::end(workspace.phaseSeconds), 0.0);
+    }
+    if (observer)
+        observer->onStart("GA", numCities);
+
+    SolveResult result;
+    if (numIslands > 1)
+        result = numCities < 65536 ? runIslands<std::uint16_t>(stop) : runIslands<std::uint32_t>(stop);
+    else
+        result = numCities < 65536 ? run<std::uint16_t>(stop) : run<std::uint32_t>(stop);
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
 }
@@ -0,0 +1,178 @@
+﻿#include "InstanceEdits.h"
+
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+namespace {
+
+std::vector<int> identityIndex(int size)
+{
+    std::vector<int> index(size);
+    for (int i = 0; i < size; ++i)
+        index[i] = i;
+    return index;
+}
+
+// Копия матрицы размера size, где город i новой задачи - город previousIndex[i] прежней.
+// Расстояния до новых городов остаются нулевыми и заполняются вызывающим кодом
+std::shared_ptr<DistanceMatrix> remapMatrix(const DistanceMatrix& matrix, const std::vector<int>& previousIndex)
+{
+    const int size = static_cast<int>(previousIndex.size());
+    auto result = std::make_shared<DistanceMatrix>(size, matrix.precision(), matrix.layout());
+    const bool full = matrix.layout() == DistanceMatrix::Layout::Full;
+    for (int i = 0; i < size; ++i)
+    {
+        if (previousIndex[i] < 0)
+            continue;
+        for (int j = full ? 0 : i + 1; j < size; ++j)
+            if (previousIndex[j] >= 0)
+                result->set(i, j, matrix(previousIndex[i], previousIndex[j]));
+    }
+    return result;
+}
+
+// Копия координат с тем же отображением; новые города берут координаты (x, y)
+std::shared_ptr<CoordinateDistances> remapCoordinates(const CoordinateDistances& coordinates,
+                                                      const std::vector<int>& previousIndex, double x, double y)
+{
+    std::vector<double> xs(previousIndex.size(), x);
+    std::vector<double> ys(previousIndex.size(), y);
+    for (std::size_t i = 0; i < previousIndex.size(); ++i)
+    {
+        if (previousIndex[i] < 0)
+            continue;
+        xs[i] = coordinates.getX(previousIndex[i]);
+        ys[i] = coordinates.getY(previousIndex[i]);
+    }
+    return std::make_shared<CoordinateDistances>(std::move(xs), std::move(ys), coordinates.metric(),
+                                                 coordinates.cacheSlotsPerRow());
+}
+
+void checkCity(const TspInstance& instance, int city)
+{
+    if (city < 0 || city >= instance.size())
+        throw std::invalid_argument("InstanceEdits: номер города вне диапазона");
+}
+
+} // namespace
+
+EditedInstance addCity(const TspInstance& instance, const std::vector<double>& distances)
+{
+    if (instance.hasCoordinates())
+        throw std::invalid_argument("InstanceEdits: задача задана координатами, нужен addCity(instance, x, y)");
+    const int size = instance.size();
+    if (static_cast<int>(distances.size()) != size)
+        throw std::invalid_argument("InstanceEdits: число расстояний не совпадает с числом городов");
+
+    std::vector<int> previousIndex = identityIndex(size);
+    previousIndex.push_back(-1);
+    std::shared_ptr<DistanceMatrix> matrix = remapMatrix(*instance.matrix(), previousIndex);
+    for (int i = 0; i < size; ++i)
+    {
+        matrix->set(i, size, distances[i]);
+        matrix->set(size, i, distances[i]);
+    }
+    return { TspInstance(matrix), previousIndex };
+}
+
+EditedInstance addCity(const TspInstance& instance, double x, double y)
+{
+    if (!instance.hasCoordinates())
+        throw std::invalid_argument("InstanceEdits: задача задана матрицей, нужен addCity(instance, distances)");
+    std::vector<int> previousIndex = identityIndex(instance.size());
+    previousIndex.push_back(-1);
+    return { TspInstance(remapCoordinates(*instance.coordinates(), previousIndex, x, y)), previousIndex };
+}
+
+EditedInstance removeCity(const TspInstance& instance, int city)
+{
+    checkCity(instance, city);
+    std::vector<int> previousIndex;
+    previousIndex.reserve(instance.size() - 1);
+    for (int i = 0; i < instance.size(); ++i)
+        if (i != city)
+            previousIndex.push_back(i);
+    if (instance.hasCoordinates())
+        return { TspInstance(remapCoordinates(*instance.coordinates(), previousIndex, 0.0, 0.0)), previousIndex };
+    return { TspInstance(remapMatrix(*instance.matrix(), previousIndex)), previousIndex };
+}
+
+EditedInstance moveCity(const TspInstance& instance, int city, double x, double y)
+{
+    if (!instance.hasCoordinates())
+        throw std::invalid_argument("InstanceEdits: moveCity применим только к задаче с координатами");
+    checkCity(instance, city);
+    // Перемещенный город считается новым: все его ребра изменились, поэтому repairTour вставляет
+    // его заново, а феромоны его ребер не переносятся
+    std::vector<int> previousIndex = identityIndex(instance.size());
+    previousIndex[city] = -1;
+    return { TspInstance(remapCoordinates(*instance.coordinates(), previousIndex, x, y)), previousIndex };
+}
+
+EditedInstance updateEdges(const TspInstance& instance, const std::vector<EdgeUpdate>& updates)
+{
+    if (instance.hasCoordinates())
+        throw std::invalid_argument("InstanceEdits: веса ребер меняются только у задачи с матрицей, для координат - moveCity");
+    std::vector<int> previousIndex = identityIndex(instance.size());
+    std::shared_ptr<DistanceMatrix> matrix = remapMatrix(*instance.matrix(), previousIndex);
+    for (const EdgeUpdate& update : updates)
+    {
+        checkCity(instance, update.from);
+        checkCity(instance, update.to);
+        matrix->set(update.from, update.to, update.weight);
+        matrix->set(update.to, update.from, update.weight);
+    }
+    return { TspInstance(matrix), previousIndex };
+}
+
+std::vector<int> repairTour(const EditedInstance& edited, const std::vector<int>& previousTour)
+{
+    const TspInstance& instance = edited.instance;
+    const int size = instance.size();
+    std::vector<int> newIndex; // Номер города прежней задачи в новой
+    for (int i = 0; i < size; ++i)
+    {
+        int previous = edited.previousIndex[i];
+        if (previous < 0)
+            continue;
+        if (previous >= static_cast<int>(newIndex.size()))
+            newIndex.resize(previous + 1, -1);
+        newIndex[previous] = i;
+    }
+
+    std::vector<int> tour;
+    tour.reserve(size);
+    for (int city : previousTour)
+        if (city >= 0 && city < static_cast<int>(newIndex.size()) && newIndex[city] >= 0)
+            tour.push_back(newIndex[city]);
+    if (static_cast<int>(tour.size()) != size - static_cast<int>(std::count(edited.previousIndex.begin(), edited.previousIndex.end(), -1)))
+        throw std::invalid_argument("InstanceEdits: прежний маршрут не соответствует прежней задаче");
+
+    // Вставка дешевейшим способом: ребро (a, b) заменяется на (a, city) и (city, b)
+    for (int city = 0; city < size; ++city)
+    {
+        if (edited.previousIndex[city] >= 0)
+            continue;
+        if (tour.size() < 2)
+        {
+            tour.push_back(city);
+            continue;
+        }
+        std::size_t bestPosition = 0;
+        double bestCost = std::numeric_limits<double>::infinity();
+        for (std::size_t k = 0; k < tour.size(); ++k)
+        {
+            int a = tour[k];
+            int b = tour[(k + 1) % tour.size()];
+            double cost = instance(a, city) + instance(city, b) - instance(a, b);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestPosition = k + 1;
+            }
+        }
+        tour.insert(tour.begin() + bestPosition, city);
+    }
+    return tour;
+}
@@ -0,0 +1,182 @@
+﻿#include "KdTree.h"
+
+#include <algorithm>
+#include <limits>
+
+KdTree::KdTree(std::vector<double> xs, std::vector<double> ys):
+    x(std::move(xs)),
+    y(std::move(ys)),
+    order(x.size()),
+    axis(x.size(), 0),
+    position(x.size())
+{
+    for (int i = 0; i < static_cast<int>(order.size()); ++i)
+        order[i] = i;
+    build(0, static_cast<int>(order.size()));
+    for (int i = 0; i < static_cast<int>(order.size()); ++i)
+        position[order[i]] = i;
+}
+
+// Рекурсивное построение: разбиение по медиане вдоль оси с наибольшим разбросом
+void KdTree::build(int lo, int hi)
+{
+    if (hi - lo <= 1)
+        return;
+
+    double minX = x[order[lo]], maxX = minX, minY = y[order[lo]], maxY = minY;
+    for (int i = lo + 1; i < hi; ++i)
+    {
+        minX = std::min(minX, x[order[i]]);
+        maxX = std::max(maxX, x[order[i]]);
+        minY = std::min(minY, y[order[i]]);
+        maxY = std::max(maxY, y[order[i]]);
+    }
+    unsigned char splitAxis = (maxX - minX) >= (maxY - minY) ? 0 : 1;
+    const std::vector<double>& coord = splitAxis == 0 ? x : y;
+
+    int mid = (lo + hi) / 2;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [&coord](int a, int b) { return coord[a] < coord[b]; });
+    axis[mid] = splitAxis;
+
+    build(lo, mid);
+    build(mid + 1, hi);
+}
+
+// Обход с отсечением: heap - max-куча из не более чем k кандидатов (квадрат расстояния, город)
+void KdTree::search(int lo, int hi, double qx, double qy, int k, int exclude,
+                    std::vector<std::pair<double, int>>& heap) const
+{
+    if (lo >= hi)
+        return;
+
+    int mid = (lo + hi) / 2;
+    int city = order[mid];
+    if (city != exclude)
+    {
+        double dx = x[city] - qx;
+        double dy = y[city] - qy;
+        double d2 = dx * dx + dy * dy;
+        if (static_cast<int>(heap.size()) < k)
+        {
+            heap.emplace_back(d2, city);
+            std::push_heap(heap.begin(), heap.end());
+        }
+        else if (d2 < heap.front().first)
+        {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = std::make_pair(d2, city);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    double diff = axis[mid] == 0 ? qx - x[city] : qy - y[city];
+    int nearLo = diff < 0 ? lo : mid + 1;
+    int nearHi = diff < 0 ? mid : hi;
+    int farLo = diff < 0 ? mid + 1 : lo;
+    int farHi = diff < 0 ? hi : mid;
+
+    search(nearLo, nearHi, qx, qy, k, exclude, heap);
+    if (static_cast<int>(heap.size()) < k || diff * diff < heap.front().first)
+        search(farLo, farHi, qx, qy, k, exclude, heap);
+}
+
+void KdTree::nearest(double qx, double qy, int k, int exclude, std::vector<int>& result) const
+{
+    std::vector<std::pair<double, int>> heap;
+    heap.reserve(k + 1);
+    search(0, static_cast<int>(order.size()), qx, qy, k, exclude, heap);
+    std::sort_heap(heap.begin(), heap.end());
+
+    result.clear();
+    for (const auto& entry : heap)
+        result.push_back(entry.second);
+}
+
+int KdTree::fillCounts(int lo, int hi, std::vector<int>& count) const
+{
+    if (lo >= hi)
+        return 0;
+    int mid = (lo + hi) / 2;
+    count[mid] = fillCounts(lo, mid, count) + fillCounts(mid + 1, hi, count) + 1;
+    return count[mid];
+}
+
+void KdTree::fillSubset(Subset& subset, bool all) const
+{
+    subset.count.assign(order.size(), 0);
+    subset.member.assign(order.size(), all ? 1 : 0);
+    if (all)
+        fillCounts(0, static_cast<int>(order.size()), subset.count);
+}
+
+// Спуск от корня к узлу города с изменением счетчиков на пути: O(log N)
+void KdTree::updateCounts(Subset& subset, int city, int delta) const
+{
+    int target = position[city];
+    int lo = 0;
+    int hi = static_cast<int>(order.size());
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        subset.count[mid] += delta;
+        if (target == mid)
+            break;
+        if (target < mid)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+}
+
+void KdTree::insert(Subset& subset, int city) const
+{
+    if (subset.member[city])
+        return;
+    subset.member[city] = 1;
+    updateCounts(subset, city, 1);
+}
+
+void KdTree::erase(Subset& subset, int city) const
+{
+    if (!subset.member[city])
+        return;
+    subset.member[city] = 0;
+    updateCounts(subset, city, -1);
+}
+
+// Поиск ближайшего с отсечением поддеревьев, в которых нет городов подмножества
+void KdTree::searchIn(int lo, int hi, const Subset& subset, double qx, double qy, double& bestDistance, int& best) const
+{
+    if (lo >= hi)
+        return;
+    int mid = (lo + hi) / 2;
+    if (subset.count[mid] == 0)
+        return;
+
+    int city = order[mid];
+    if (subset.member[city])
+    {
+        double dx = x[city] - qx;
+        double dy = y[city] - qy;
+        double d2 = dx * dx + dy * dy;
+        if (d2 < bestDistance)
+        {
+            bestDistance = d2;
+            best = city;
+        }
+    }
+
+    double diff = axis[mid] == 0 ? qx - x[city] : qy - y[city];
+    searchIn(diff < 0 ? lo : mid + 1, diff < 0 ? mid : hi, subset, qx, qy, bestDistance, best);
+    if (diff * diff < bestDistance)
+        searchIn(diff < 0 ? mid + 1 : lo, diff < 0 ? hi : mid, subset, qx, qy, bestDistance, best);
+}
+
+int KdTree::nearestIn(const Subset& subset, double qx, double qy) const
+{
+    double bestDistance = std::numeric_limits<double>::infinity();
+    int best = -1;
+    searchIn(0, static_cast<int>(order.size()), subset, qx, qy, bestDistance, best);
+    return best;
+}
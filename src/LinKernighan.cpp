@@ -0,0 +1,359 @@
+﻿#include "LinKernighan.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    const double kEpsilon = 1e-9;     // Выигрыш меньше погрешности не считается улучшением
+    const int kMaxSegment = 50;       // Наибольшая длина участка в double bridge
+    const int kReportInterval = 100;  // Прогресс сообщается раз в столько возмущений
+
+    // Число вариантов, перебираемых на уровне цепочки (дальше - только лучший)
+    int breadth(int level)
+    {
+        return level == 1 ? 5 : level == 2 ? 3 : 1;
+    }
+}
+
+LinKernighan::LinKernighan(const std::vector<std::vector<double>>& distanceMatrix, int kicks, int maxDepth):
+      LinKernighan(TspInstance(distanceMatrix), kicks, maxDepth) {}
+
+LinKernighan::LinKernighan(const TspInstance& distances, int kicks, int maxDepth):
+      distances(distances),
+      kicks(kicks),
+      maxDepth(std::max(3, maxDepth)),
+      seed(Random::randomSeed()) {}
+
+// Новая задача для того же объекта; память маршрута и журнала переиспользуется
+void LinKernighan::setInstance(const TspInstance& instance)
+{
+    distances = instance;
+    candidates.reset();
+    construction.reset();
+    initialTours.clear();
+    exchange.reset();
+}
+
+void LinKernighan::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+// Начальный маршрут строится эвристикой: первый спуск от хорошего маршрута заметно короче
+void LinKernighan::setConstruction(std::shared_ptr<const TourConstruction> newConstruction)
+{
+    construction = std::move(newConstruction);
+}
+
+void LinKernighan::setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists)
+{
+    candidates = std::move(candidateLists);
+}
+
+// Наблюдатель получает прогресс после первого спуска и каждые 100 возмущений
+void LinKernighan::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
+
+double LinKernighan::calculatePathLength(const std::vector<int>& path)
+{
+    double length = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+        length += distances(path[i], path[i + 1]);
+    length += distances(path.back(), path[0]);
+    return length;
+}
+
+template <typename Tour>
+void LinKernighan::applyFlip(Tour& tour, int a, int b, int c, int d)
+{
+    tour.twoOptMove(a, b, c, d);
+    flips.push_back({ a, b, c, d });
+}
+
+// Отмена обменов журнала до длины flipCount в обратном порядке
+template <typename Tour>
+void LinKernighan::rollback(Tour& tour, std::size_t flipCount)
+{
+    while (flips.size() > flipCount)
+    {
+        const Flip& flip = flips.back();
+        tour.twoOptMove(flip.a, flip.c, flip.b, flip.d);
+        flips.pop_back();
+    }
+}
+
+bool LinKernighan::isAdded(int a, int b) const
+{
+    for (const std::pair<int, int>& edge : added)
+        if ((edge.first == a && edge.second == b) || (edge.first == b && edge.second == a))
+            return true;
+    return false;
+}
+
+// Шаг цепочки. Маршрут замкнут ребром (t1, t2), gain - сумма удаленных минус сумма добавленных
+// ребер без учета (t1, t2). Обмен удаляет (t1, t2) и (t4, t3), добавляет (t2, t3) и (t1, t4),
+// после чего цепочка продолжается от t4
+template <typename Tour>
+void LinKernighan::step(Tour& tour, int level, int t1, int t2, double gain)
+{
+    struct Alternative {
+        int t3;
+        int t4;
+        double gain; // Частичный выигрыш после удаления (t4, t3)
+    };
+    Alternative alternatives[5] = {};
+    int count = 0;
+    const int width = breadth(level);
+    const bool forward = tour.next(t1) == t2;
+
+    for (const int* it = candidates->begin(t2); it != candidates->end(t2); ++it)
+    {
+        int t3 = *it;
+        double g1 = gain - distances(t2, t3);
+        if (g1 <= kEpsilon) // Критерий положительного выигрыша; кандидаты упорядочены
+            break;
+        int t4 = forward ? tour.prev(t3) : tour.next(t3);
+        if (t3 == t1 || t4 == t2 || isAdded(t3, t4))
+            continue;
+        ++evaluations;
+
+        // Варианты упорядочены по выигрышу после удаления второго ребра
+        Alternative alternative = { t3, t4, g1 + distances(t3, t4) };
+        int position = count < width ? count++ : width;
+        while (position > 0 && alternatives[position - 1].gain < alternative.gain)
+        {
+            if (position < width)
+                alternatives[position] = alternatives[position - 1];
+            --position;
+        }
+        if (position < width)
+            alternatives[position] = alternative;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        const Alternative alternative = alternatives[i];
+        applyFlip(tour, t1, t2, alternative.t4, alternative.t3);
+        added.push_back({ t2, alternative.t3 });
+
+        double closedGain = alternative.gain - distances(alternative.t4, t1);
+        if (closedGain > bestGain + kEpsilon)
+        {
+            bestGain = closedGain;
+            bestFlipCount = flips.size();
+        }
+        if (level < maxDepth)
+            step(tour, level + 1, t1, alternative.t4, alternative.gain);
+        if (bestGain > kEpsilon) // Улучшение найдено: цепочка фиксируется по лучшей точке
+            return;
+
+        added.pop_back();
+        rollback(tour, flips.size() - 1);
+    }
+}
+
+// Поиск улучшающей цепочки из города t1 в обоих направлениях; возвращает выигрыш
+template <typename Tour>
+double LinKernighan::improveCity(Tour& tour, int t1)
+{
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        int t2 = direction == 0 ? tour.next(t1) : tour.prev(t1);
+        const std::size_t base = flips.size();
+        bestGain = 0.0;
+        bestFlipCount = base;
+        added.clear();
+        step(tour, 1, t1, t2, distances(t1, t2));
+        rollback(tour, bestFlipCount);
+        if (bestGain > kEpsilon)
+        {
+            for (std::size_t f = base; f < flips.size(); ++f)
+            {
+                queue.push(flips[f].a);
+                queue.push(flips[f].b);
+                queue.push(flips[f].c);
+                queue.push(flips[f].d);
+            }
+            return bestGain;
+        }
+    }
+    return 0.0;
+}
+
+// Спуск до локального оптимума по активным городам; возвращает изменение длины (<= 0)
+template <typename Tour>
+double LinKernighan::optimize(Tour& tour)
+{
+    double total = 0.0;
+    while (!queue.empty())
+    {
+        int t1 = queue.pop();
+        double gain = improveCity(tour, t1);
+        if (gain > 0.0)
+        {
+            total -= gain;
+            queue.push(t1);
+        }
+    }
+    return total;
+}
+
+std::vector<int> LinKernighan::solve()
+{
+    return solve(StopPolicy()).tour;
+}
+
+// Запуск с условиями остановки; условия проверяются перед каждым возмущением
+SolveResult LinKernighan::solve(const StopPolicy& policy)
+{
+    checkInitialTours(distances.size());
+    StopCondition stop(policy);
+    if (distances.size() >= kTwoLevelTourMinCities)
+        return run(listTour, stop);
+    return run(arrayTour, stop);
+}
+
+template <typename Tour>
+SolveResult LinKernighan::run(Tour& tour, const StopCondition& stop)
+{
+    SolveResult result;
+    random.reseed(seed);
+    evaluations = 0;
+    double phaseSeconds[kSolverPhaseCount] = {};
+    PhaseTimer timer(observer != nullptr);
+    const int numCities = distances.size();
+    if (observer)
+        observer->onStart("LK", numCities);
+
+    // Начальный маршрут - лучший из маршрутов теплого старта, построенный эвристикой
+    // либо случайная перестановка
+    std::vector<int> initial(numCities);
+    if (!initialTours.empty())
+    {
+        initial = *std::min_element(initialTours.begin(), initialTours.end(),
+            [&](const std::vector<int>& a, const std::vector<int>& b) { return calculatePathLength(a) < calculatePathLength(b); });
+    }
+    else if (construction)
+    {
+        construction->build(initial, random);
+    }
+    else
+    {
+        for (int i = 0; i < numCities; ++i)
+            initial[i] = i;
+        std::shuffle(initial.begin(), initial.end(), random);
+    }
+    tour.assign(initial);
+    queue.reset(numCities);
+    flips.clear();
+    std::shared_ptr<const CandidateLists> lists = candidates;
+    if (!lists && numCities >= 5)
+        lists = std::make_shared<CandidateLists>(distances, std::min(10, numCities - 1));
+    std::swap(candidates, lists); // Списки, построенные здесь, живут только до конца solve
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+
+    double length = numCities > 0 ? calculatePathLength(initial) : 0.0;
+    if (numCities >= 5)
+    {
+        for (int city : initial)
+            queue.push(city);
+        length += optimize(tour);
+        flips.clear();
+    }
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+    if (observer)
+        observer->onProgress({ "LK", 0, length, length, -1.0, -1.0, evaluations, phaseSeconds });
+
+    int kick = 0;
+    int noImprovementKicks = 0;
+    result.reason = StopReason::IterationLimit;
+    std::vector<int> shared;
+    for (; numCities >= 8 && kick < kicks; ++kick)
+    {
+        // Обмен с другими солверами портфеля: общий маршрут, если он короче, доводится
+        // до локального оптимума и заменяет текущий
+        if (exchange)
+        {
+            if (length < exchange->bestLength())
+            {
+                exchange->publish(tour.cities(), length);
+            }
+            else if (importExchange && exchange->fetchIfShorter(shared, length))
+            {
+                tour.assign(shared);
+                for (int city : shared)
+                    queue.push(city);
+                length += optimize(tour);
+                flips.clear();
+                noImprovementKicks = 0;
+            }
+        }
+
+        StopReason reason = stop.check(length, evaluations, noImprovementKicks);
+        if (reason != StopReason::None)
+        {
+            result.reason = reason;
+            break;
+        }
+
+        // Double bridge на коротком отрезке: участки B и C меняются местами (a B C d -> a C B d)
+        const int maxLength = std::max(1, std::min(kMaxSegment, numCities / 4));
+        const int length1 = random.between(1, maxLength);
+        const int length2 = random.between(1, maxLength);
+        const int b0 = tour.cityAt(random.below(numCities));
+        const int a = tour.prev(b0);
+        int bL = b0;
+        for (int k = 1; k < length1; ++k)
+            bL = tour.next(bL);
+        const int c0 = tour.next(bL);
+        int cL = c0;
+        for (int k = 1; k < length2; ++k)
+            cL = tour.next(cL);
+        const int d = tour.next(cL);
+        double kickDelta = distances(a, c0) + distances(cL, b0) + distances(bL, d)
+                         - distances(a, b0) - distances(bL, c0) - distances(cL, d);
+        tour.swapSegments(b0, length1, length2);
+        for (int city : { a, b0, bL, c0, cL, d })
+            queue.push(city);
+
+        double delta = kickDelta + optimize(tour);
+        if (delta < -kEpsilon)
+        {
+            length += delta;
+            noImprovementKicks = 0;
+        }
+        else
+        {
+            // Возврат к маршруту до возмущения: обмены отменяются, затем участки меняются обратно
+            // (направление обхода после обменов могло смениться)
+            rollback(tour, 0);
+            if (tour.next(a) == c0)
+                tour.swapSegments(c0, length2, length1);
+            else
+                tour.swapSegments(bL, length1, length2);
+            ++noImprovementKicks;
+        }
+        flips.clear();
+
+        if (observer && (kick + 1) % kReportInterval == 0)
+        {
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+            observer->onProgress({ "LK", kick + 1, length, length, -1.0, -1.0, evaluations, phaseSeconds });
+        }
+    }
+    std::swap(candidates, lists);
+
+    if (observer)
+    {
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::LocalSearch)]);
+        observer->onFinish({ "LK", kick, length, length, -1.0, -1.0, evaluations, phaseSeconds });
+    }
+    result.tour = tour.cities();
+    result.length = length;
+    result.iterations = kick;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
+}
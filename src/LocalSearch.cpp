@@ -0,0 +1,163 @@
+﻿#include "LocalSearch.h"
+#include <algorithm>
+
+namespace
+{
+    const double kEpsilon = 1e-9; // Ход применяется, только если выигрыш больше погрешности
+}
+
+LocalSearch::LocalSearch(const TspInstance& distances, std::shared_ptr<const CandidateLists> candidates):
+    distances(distances),
+    candidates(std::move(candidates)),
+    orOpt(true),
+    maxSegment(3) {}
+
+// Or-opt переносит участки длиной от 1 до maxSegment городов
+void LocalSearch::setOrOpt(bool enabled, int segment)
+{
+    orOpt = enabled;
+    maxSegment = std::max(1, segment);
+}
+
+// Поиск улучшающего 2-opt хода для ребер, выходящих из города a в обе стороны
+template <typename Tour>
+double LocalSearch::improveTwoOpt(Tour& tour, ActiveQueue& queue, int a) const
+{
+    const int count = candidates->count();
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        int b = direction == 0 ? tour.next(a) : tour.prev(a);
+        double removed = distances(a, b);
+        for (int rank = 0; rank < count; ++rank)
+        {
+            int c = candidates->get(a, rank);
+            double added = distances(a, c);
+            if (added >= removed - kEpsilon) // Кандидаты упорядочены, дальше выигрыша нет
+                break;
+            int d = direction == 0 ? tour.next(c) : tour.prev(c);
+            if (c == b || d == a)
+                continue;
+            double delta = added + distances(b, d) - removed - distances(c, d);
+            if (delta < -kEpsilon)
+            {
+                tour.twoOptMove(a, b, c, d);
+                for (int city : { a, b, c, d })
+                    queue.push(city);
+                return delta;
+            }
+        }
+    }
+    return 0.0;
+}
+
+// Поиск улучшающего Or-opt хода: участок a..e (от a в прямом направлении) переносится
+// между соседним к a или e кандидатом x и его соседом y. Перенос выражается двумя или
+// тремя 2-opt ходами. Вставка рядом с p или n совпадает с 2-opt ходом и пропускается
+template <typename Tour>
+double LocalSearch::improveOrOpt(Tour& tour, ActiveQueue& queue, int a) const
+{
+    const int count = candidates->count();
+    int p = tour.prev(a);
+    int e = a;
+    for (int length = 1; length <= maxSegment && length + 3 <= tour.size(); ++length)
+    {
+        if (length > 1)
+            e = tour.next(e);
+        int n = tour.next(e);
+        double removeGain = distances(p, a) + distances(e, n) - distances(p, n);
+        if (removeGain <= kEpsilon)
+            continue;
+
+        auto inSegment = [&](int city) { return tour.between(a, city, e); };
+
+        // end - конец участка, который станет соседом кандидата x
+        for (int end : { a, e })
+        {
+            for (int rank = 0; rank < count; ++rank)
+            {
+                int x = candidates->get(end, rank);
+                double added = distances(end, x);
+                if (added >= removeGain - kEpsilon)
+                    break;
+                if (inSegment(x))
+                    continue;
+                for (int side = 0; side < 2; ++side)
+                {
+                    // Вставка в ребро (x, y) направленное вперед: left - y, right - x соответственно
+                    int left = side == 0 ? x : tour.prev(x);
+                    int right = side == 0 ? tour.next(x) : x;
+                    if (inSegment(left) || inSegment(right) || left == n || right == p)
+                        continue;
+                    // Город участка, который окажется рядом с left: end при side == 0, иначе другой конец
+                    int other = end == a ? e : a;
+                    int nearLeft = side == 0 ? end : other;
+                    int nearRight = side == 0 ? other : end;
+                    double delta = distances(left, nearLeft) + distances(nearRight, right) - distances(left, right) - removeGain;
+                    if (delta < -kEpsilon)
+                    {
+                        // left-e..a-right
+                        tour.twoOptMove(p, a, left, right);
+                        tour.twoOptMove(p, left, n, e);
+                        if (nearLeft == a) // left-a..e-right
+                            tour.twoOptMove(left, e, a, right);
+                        for (int city : { p, n, a, e, left, right })
+                            queue.push(city);
+                        return delta;
+                    }
+                }
+            }
+        }
+    }
+    return 0.0;
+}
+
+double LocalSearch::improve(std::vector<int>& cities, Workspace& workspace) const
+{
+    return improve(cities, cities, workspace);
+}
+
+double LocalSearch::improve(std::vector<int>& cities, const std::vector<int>& active, Workspace& workspace) const
+{
+    const int numCities = static_cast<int>(cities.size());
+    if (numCities < 5 || !candidates || candidates->count() == 0)
+        return 0.0;
+
+    workspace.queue.reset(numCities);
+    for (int city : active)
+        workspace.queue.push(city);
+
+    double total;
+    if (numCities >= kTwoLevelTourMinCities)
+    {
+        workspace.listTour.assign(cities);
+        total = descend(workspace.listTour, workspace.queue);
+        cities = workspace.listTour.cities();
+    }
+    else
+    {
+        workspace.tour.assign(cities);
+        total = descend(workspace.tour, workspace.queue);
+        cities = workspace.tour.cities();
+    }
+    return total;
+}
+
+template <typename Tour>
+double LocalSearch::descend(Tour& tour, ActiveQueue& queue) const
+{
+    double total = 0.0;
+    while (!queue.empty())
+    {
+        int city = queue.pop();
+        // Город остается активным, пока вокруг него находятся улучшения
+        double delta = improveTwoOpt(tour, queue, city);
+        if (delta == 0.0 && orOpt)
+            delta = improveOrOpt(tour, queue, city);
+        if (delta != 0.0)
+        {
+            total += delta;
+            queue.push(city);
+        }
+    }
+    return total;
+}
@@ -0,0 +1,284 @@
+﻿#include "MatrixFile.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[8] = { 'T', 'S', 'P', 'M', 'A', 'T', 'R', 'X' };
+const std::uint32_t kVersion = 1;
+const std::uint32_t kByteOrder = 0x01020304;
+
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader: заголовок должен занимать 64 байта");
+
+// FNV-1a по 64-битным словам; данные можно подавать частями любой длины
+class Checksum {
+public:
+    void update(const void* data, std::size_t bytes)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        while (bytes > 0 && pendingBytes > 0)
+        {
+            addByte(*p++);
+            --bytes;
+        }
+        for (; bytes >= 8; bytes -= 8, p += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, p, 8);
+            mix(word);
+        }
+        while (bytes-- > 0)
+            addByte(*p++);
+    }
+
+    std::uint64_t value()
+    {
+        if (pendingBytes > 0)
+        {
+            mix(pending);
+            pending = 0;
+            pendingBytes = 0;
+        }
+        return hash;
+    }
+
+private:
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    std::uint64_t pending = 0;
+    int pendingBytes = 0;
+
+    void mix(std::uint64_t word) { hash = (hash ^ word) * 0x100000001b3ULL; }
+
+    void addByte(unsigned char byte)
+    {
+        pending |= static_cast<std::uint64_t>(byte) << (8 * pendingBytes);
+        if (++pendingBytes == 8)
+        {
+            mix(pending);
+            pending = 0;
+            pendingBytes = 0;
+        }
+    }
+};
+
+std::uint32_t valueType(DistanceMatrix::Precision precision)
+{
+    switch (precision)
+    {
+    case DistanceMatrix::Precision::Double:
+        return 0;
+    case DistanceMatrix::Precision::Float:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+std::size_t valueSize(DistanceMatrix::Precision precision)
+{
+    return precision == DistanceMatrix::Precision::Double ? sizeof(double) : 4;
+}
+
+std::uint64_t elementCount(std::uint64_t size, bool symmetric)
+{
+    return symmetric ? size * (size - (size > 0 ? 1 : 0)) / 2 : size * size;
+}
+
+MatrixFileHeader makeHeader(std::uint64_t size, DistanceMatrix::Precision precision, DistanceMatrix::Layout layout)
+{
+    MatrixFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrder;
+    header.size = size;
+    header.valueType = valueType(precision);
+    header.symmetric = layout == DistanceMatrix::Layout::UpperTriangular ? 1 : 0;
+    header.dataBytes = elementCount(size, header.symmetric != 0) * valueSize(precision);
+    return header;
+}
+
+// Значение в формате хранения (как DistanceMatrix::set)
+void appendValue(std::vector<char>& buffer, double value, DistanceMatrix::Precision precision)
+{
+    char bytes[sizeof(double)];
+    std::size_t size = valueSize(precision);
+    if (precision == DistanceMatrix::Precision::Double)
+    {
+        std::memcpy(bytes, &value, size);
+    }
+    else if (precision == DistanceMatrix::Precision::Float)
+    {
+        float v = static_cast<float>(value);
+        std::memcpy(bytes, &v, size);
+    }
+    else
+    {
+        std::int32_t v = static_cast<std::int32_t>(std::lround(value));
+        std::memcpy(bytes, &v, size);
+    }
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+std::ofstream openOutput(const std::string& path)
+{
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output)
+        throw std::runtime_error("MatrixFile: не удалось создать файл " + path);
+    return output;
+}
+
+// Заголовок пишется в начало файла после данных, когда известна контрольная сумма
+void finishOutput(std::ofstream& output, const std::string& path, MatrixFileHeader header, std::uint64_t checksum)
+{
+    header.checksum = checksum;
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.flush();
+    if (!output)
+        throw std::runtime_error("MatrixFile: ошибка записи файла " + path);
+}
+
+// Отображенная область файла; освобождается вместе с последней матрицей, которая на нее ссылается
+std::shared_ptr<void> mapReadOnly(const std::string& path, std::uint64_t& fileSize)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("MatrixFile: не удалось открыть файл " + path);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("MatrixFile: пустой файл " + path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        throw std::runtime_error("MatrixFile: не удалось отобразить файл " + path);
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping); // Представление удерживает отображение само
+    if (!address)
+        throw std::runtime_error("MatrixFile: не удалось отобразить файл " + path);
+    fileSize = static_cast<std::uint64_t>(size.QuadPart);
+    return std::shared_ptr<void>(address, [](void* p) { UnmapViewOfFile(p); });
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("MatrixFile: не удалось открыть файл " + path);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        throw std::runtime_error("MatrixFile: пустой файл " + path);
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // Отображение остается действительным после закрытия файла
+    if (address == MAP_FAILED)
+        throw std::runtime_error("MatrixFile: не удалось отобразить файл " + path);
+    fileSize = size;
+    return std::shared_ptr<void>(address, [size](void* p) { munmap(p, size); });
+#endif
+}
+
+} // namespace
+
+void writeMatrixFile(const std::string& path, const DistanceMatrix& matrix)
+{
+    MatrixFileHeader header = makeHeader(matrix.size(), matrix.precision(), matrix.layout());
+    std::size_t bytes = matrix.elementCount() * matrix.elementSize();
+    Checksum checksum;
+    checksum.update(matrix.rawData(), bytes);
+
+    std::ofstream output = openOutput(path);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(static_cast<const char*>(matrix.rawData()), static_cast<std::streamsize>(bytes));
+    finishOutput(output, path, header, checksum.value());
+}
+
+void convertTextMatrix(std::istream& input, const std::string& path,
+                       DistanceMatrix::Precision precision, DistanceMatrix::Layout layout)
+{
+    long long size = 0;
+    if (!(input >> size) || size < 0 || size > std::numeric_limits<int>::max())
+        throw std::runtime_error("MatrixFile: в начале текстовой матрицы ожидается число городов");
+    MatrixFileHeader header = makeHeader(static_cast<std::uint64_t>(size), precision, layout);
+    const bool upper = layout == DistanceMatrix::Layout::UpperTriangular;
+
+    std::ofstream output = openOutput(path);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    Checksum checksum;
+    std::vector<char> row;
+    row.reserve(static_cast<std::size_t>(size) * valueSize(precision));
+    for (long long i = 0; i < size; ++i)
+    {
+        row.clear();
+        for (long long j = 0; j < size; ++j)
+        {
+            double value;
+            if (!(input >> value))
+                throw std::runtime_error("MatrixFile: в текстовой матрице не хватает чисел");
+            if (!upper || j > i)
+                appendValue(row, value, precision);
+        }
+        checksum.update(row.data(), row.size());
+        output.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    finishOutput(output, path, header, checksum.value());
+}
+
+std::shared_ptr<const DistanceMatrix> mapMatrixFile(const std::string& path, bool verify)
+{
+    std::uint64_t fileSize = 0;
+    std::shared_ptr<void> mapping = mapReadOnly(path, fileSize);
+    if (fileSize < sizeof(MatrixFileHeader))
+        throw std::runtime_error("MatrixFile: файл короче заголовка: " + path);
+
+    MatrixFileHeader header;
+    std::memcpy(&header, mapping.get(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("MatrixFile: файл не является двоичной матрицей: " + path);
+    if (header.byteOrder != kByteOrder)
+        throw std::runtime_error("MatrixFile: файл записан с другим порядком байтов: " + path);
+    if (header.version != kVersion)
+        throw std::runtime_error("MatrixFile: неподдерживаемая версия формата: " + path);
+    if (header.valueType > 2 || header.symmetric > 1 || header.size > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+        throw std::runtime_error("MatrixFile: некорректный заголовок: " + path);
+
+    const DistanceMatrix::Precision precision = header.valueType == 0 ? DistanceMatrix::Precision::Double
+                                              : header.valueType == 1 ? DistanceMatrix::Precision::Float
+                                                                      : DistanceMatrix::Precision::Int32;
+    const DistanceMatrix::Layout layout = header.symmetric ? DistanceMatrix::Layout::UpperTriangular
+                                                           : DistanceMatrix::Layout::Full;
+    if (header.dataBytes != elementCount(header.size, header.symmetric != 0) * valueSize(precision) ||
+        fileSize - sizeof(MatrixFileHeader) < header.dataBytes)
+        throw std::runtime_error("MatrixFile: размер данных не соответствует заголовку: " + path);
+
+    char* data = static_cast<char*>(mapping.get()) + sizeof(MatrixFileHeader);
+    if (verify)
+    {
+        Checksum checksum;
+        checksum.update(data, static_cast<std::size_t>(header.dataBytes));
+        if (checksum.value() != header.checksum)
+            throw std::runtime_error("MatrixFile: контрольная сумма не совпадает: " + path);
+    }
+    return std::shared_ptr<const DistanceMatrix>(
+        new DistanceMatrix(static_cast<int>(header.size), precision, layout, std::move(mapping), data));
+}
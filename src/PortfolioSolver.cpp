@@ -0,0 +1,161 @@
+﻿#include "PortfolioSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    const std::chrono::milliseconds kMonitorInterval(1); // Период проверки отмены и достижения цели
+}
+
+PortfolioSolver::PortfolioSolver(const TspInstance& distances, std::vector<SolverConfig> solverConfigs, bool shareTours):
+    distances(distances),
+    configs(std::move(solverConfigs)),
+    shareTours(shareTours),
+    seed(Random::randomSeed()),
+    pool(static_cast<int>(configs.size()) + 1)
+{
+    if (configs.empty())
+        throw std::invalid_argument("PortfolioSolver: портфель не содержит солверов");
+    for (const SolverConfig& config : configs)
+        if (!config.create)
+            throw std::invalid_argument("PortfolioSolver: не задано создание солвера");
+    solvers.resize(configs.size());
+}
+
+void PortfolioSolver::setInstance(const TspInstance& instance)
+{
+    distances = instance;
+    for (std::unique_ptr<TspSolver>& solver : solvers)
+        if (solver)
+            solver->setInstance(instance);
+    candidates.reset();
+    initialTours.clear();
+    exchange.reset();
+}
+
+void PortfolioSolver::setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists)
+{
+    candidates = std::move(candidateLists);
+}
+
+void PortfolioSolver::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+void PortfolioSolver::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
+
+double PortfolioSolver::calculatePathLength(const std::vector<int>& path)
+{
+    double length = 0;
+    for (size_t i = 0; i + 1 < path.size(); ++i)
+        length += distances(path[i], path[i + 1]);
+    length += distances(path.back(), path[0]);
+    return length;
+}
+
+std::vector<int> PortfolioSolver::solve()
+{
+    return solve(StopPolicy()).tour;
+}
+
+// Солверы получают свои StopPolicy из конфигураций, ограниченные общим сроком и целью, и общий
+// флаг отмены. Его взводит поток наблюдения - при отмене извне или когда общий маршрут достиг цели
+SolveResult PortfolioSolver::solve(const StopPolicy& policy)
+{
+    checkInitialTours(distances.size());
+    StopCondition stop(policy);
+    const int count = static_cast<int>(configs.size());
+    auto shared = std::make_shared<TourExchange>();
+    auto stopAll = std::make_shared<CancellationToken>();
+    std::chrono::steady_clock::time_point deadline = policy.deadline;
+    if (policy.timeLimit > std::chrono::steady_clock::duration::zero())
+        deadline = std::min(deadline, std::chrono::steady_clock::now() + policy.timeLimit);
+
+    Random master(seed);
+    std::map<int, std::shared_ptr<const CandidateLists>> lists; // Одни списки на каждую длину
+    std::vector<StopPolicy> policies(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const SolverConfig& config = configs[i];
+        std::unique_ptr<TspSolver>& solver = solvers[i];
+        if (!solver)
+            solver = config.create(distances);
+        const int size = distances.size();
+        if (candidates)
+        {
+            solver->setCandidateLists(candidates);
+        }
+        else if (config.candidates > 0 && size > 1)
+        {
+            const int k = std::min(config.candidates, size - 1);
+            if (!lists[k])
+                lists[k] = std::make_shared<CandidateLists>(distances, k);
+            solver->setCandidateLists(lists[k]);
+        }
+        if (config.configure)
+            config.configure(*solver, distances);
+        solver->setSeed(master());
+        solver->setObserver(observer);
+        solver->setInitialTours(initialTours);
+        solver->setExchange(shared, shareTours);
+
+        policies[i] = config.policy;
+        policies[i].deadline = std::min(policies[i].deadline, deadline);
+        // Без цели targetLength равен минус бесконечности, поэтому max оставляет заданную цель
+        policies[i].targetLength = std::max(policies[i].targetLength, policy.targetLength);
+        policies[i].cancellation = stopAll;
+    }
+
+    results.assign(count, SolveResult());
+    std::atomic<int> running{ count };
+    pool.run(count + 1, [&](int i) {
+        if (i == count)
+        {
+            while (running.load() > 0)
+            {
+                if ((policy.cancellation && policy.cancellation->isCancelled()) || shared->bestLength() <= policy.targetLength)
+                    stopAll->cancel();
+                std::this_thread::sleep_for(kMonitorInterval);
+            }
+            return;
+        }
+        try
+        {
+            results[i] = solvers[i]->solve(policies[i]);
+        }
+        catch (...)
+        {
+            stopAll->cancel();
+            --running;
+            throw;
+        }
+        shared->publish(results[i].tour, results[i].length);
+        --running;
+    });
+    for (std::unique_ptr<TspSolver>& solver : solvers)
+        solver->setExchange(nullptr);
+
+    int winner = 0;
+    evaluations = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        evaluations += results[i].evaluations;
+        if (results[i].length < results[winner].length)
+            winner = i;
+    }
+    SolveResult result = results[winner];
+    if (policy.cancellation && policy.cancellation->isCancelled())
+        result.reason = StopReason::Cancelled;
+    else if (result.length <= policy.targetLength)
+        result.reason = StopReason::TargetReached;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
+}
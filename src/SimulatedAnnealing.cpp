@@ -1,54 +1,230 @@
 #include "SimulatedAnnealing.h"
 
+namespace
+{
+    const int kExchangeMask = 4095; // Обмен с портфелем раз в 4096 итераций
+}
+
 SimulatedAnnealing::SimulatedAnnealing(const std::vector<std::vector<double>>& distanceMatrix, double initialTemp, 
                                        double coolingRate, int iterations): 
-      distanceMatrix(distanceMatrix), 
+      SimulatedAnnealing(TspInstance(distanceMatrix), initialTemp, coolingRate, iterations) {}
+
+SimulatedAnnealing::SimulatedAnnealing(const TspInstance& distances, double initialTemp, 
+                                       double coolingRate, int iterations): 
+      distances(distances), 
       initialTemp(initialTemp), 
       coolingRate(coolingRate), 
-      iterations(iterations) {}
+      iterations(iterations),
+      seed(Random::randomSeed()),
+      numReplicas(1),
+      swapInterval(1000),
+      replicaTemperatureRatio(5.0) {}
+
+// Новая задача для того же объекта; память цепочек переиспользуется
+void SimulatedAnnealing::setInstance(const TspInstance& instance)
+{
+    distances = instance;
+    candidates.reset();
+    construction.reset();
+    initialTours.clear();
+    exchange.reset();
+}
+
+void SimulatedAnnealing::setSeed(std::uint64_t newSeed)
+{
+    seed = newSeed;
+}
+
+// Параллельный отжиг (replica exchange): replicas цепочек, по потоку на цепочку, работают на
+// лестнице температур. Самая холодная цепочка следует обычному расписанию, самая горячая
+// в temperatureRatio раз горячее; вся лестница охлаждается с коэффициентом coolingRate.
+// Каждые interval итераций соседние по температуре цепочки обмениваются состояниями
+// по критерию Метрополиса. Цепочки синхронизируются перед обменом, поэтому при одинаковом
+// зерне результат повторяется
+void SimulatedAnnealing::setReplicas(int replicas, int interval, double temperatureRatio)
+{
+    numReplicas = std::max(1, replicas);
+    swapInterval = std::max(1, interval);
+    replicaTemperatureRatio = std::max(1.0, temperatureRatio);
+    threadPool.reset(numReplicas > 1 ? new ThreadPool(numReplicas) : nullptr);
+}
+
+// Наблюдатель получает прогресс каждые 1000 итераций; без него ничего не печатается
+void SimulatedAnnealing::setObserver(std::shared_ptr<SolverObserver> newObserver)
+{
+    observer = std::move(newObserver);
+}
 
-//   
-std::vector<int> SimulatedAnnealing::generateInitialSolution() 
+// Ходы, соединяющие город с одним из ближайших соседей, вместо случайных отрезков
+void SimulatedAnnealing::setCandidateLists(std::shared_ptr<const CandidateLists> candidateLists)
 {
-    std::vector<int> path(distanceMatrix.size());
-    for (size_t i = 0; i < path.size(); ++i)
-        path[i] = i;
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(path.begin(), path.end(), g);
-    return path;
+    candidates = std::move(candidateLists);
 }
 
-//   
+// Начальное решение строится эвристикой (у каждой цепочки - своим генератором)
+void SimulatedAnnealing::setConstruction(std::shared_ptr<const TourConstruction> newConstruction)
+{
+    construction = std::move(newConstruction);
+}
+
+// Генерация начального решения: маршрут теплого старта (цепочка index берет маршрут index
+// по кругу), маршрут, построенный эвристикой, либо случайная перестановка городов.
+// С хорошим начальным маршрутом обычно стоит понизить начальную температуру,
+// иначе первые итерации его разрушат
+void SimulatedAnnealing::initializeChain(Chain& chain, int index)
+{
+    if (!initialTours.empty())
+    {
+        chain.path = initialTours[index % initialTours.size()];
+    }
+    else if (construction)
+    {
+        construction->build(chain.path, chain.random);
+    }
+    else
+    {
+        chain.path.resize(distances.size());
+        for (size_t i = 0; i < chain.path.size(); ++i)
+            chain.path[i] = i;
+        std::shuffle(chain.path.begin(), chain.path.end(), chain.random);
+    }
+    chain.accepted = 0;
+    chain.evaluations = 0;
+    chain.lastImprovement = 0;
+    loadPath(chain);
+}
+
+// Маршрут chain.path становится текущим и лучшим решением цепочки
+void SimulatedAnnealing::loadPath(Chain& chain)
+{
+    chain.distance = calculatePathLength(chain.path);
+    chain.bestDistance = chain.distance;
+    chain.currentIsBest = true;
+    chain.bestInJournal = false;
+    chain.sinceBest.clear();
+    // В больших задачах инверсия участка массива стоит O(N), поэтому ходы выполняются
+    // над двухуровневым списком за O(sqrt(N))
+    chain.onList = candidates && candidates->count() > 0 && distances.size() >= kTwoLevelTourMinCities;
+    if (chain.onList)
+    {
+        chain.listTour.assign(chain.path);
+    }
+    else if (candidates)
+    {
+        chain.position.resize(chain.path.size());
+        for (size_t k = 0; k < chain.path.size(); ++k)
+            chain.position[chain.path[k]] = k;
+    }
+}
+
+// Вычисление длины маршрута
 double SimulatedAnnealing::calculatePathLength(const std::vector<int>& path) 
 {
     double length = 0;
     for (int i = 0; i != path.size() - 1; ++i) 
     {
-        length += distanceMatrix[path[i]][path[i + 1]];
+        length += distances(path[i], path[i + 1]);
     }
-    length += distanceMatrix[path.back()][path[0]];
+    length += distances(path.back(), path[0]);
     return length;
 }
 
-//   
-std::vector<int> SimulatedAnnealing::getNeighbor(const std::vector<int>& currentPath) 
+// Генерация соседнего решения: выбор 2-opt хода без изменения маршрута
+SimulatedAnnealing::Move SimulatedAnnealing::getNeighbor(Chain& chain) 
 {
-    std::vector<int> newPath = currentPath;
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::uniform_int_distribution<int> dist(1, newPath.size() - 1);
+    const std::vector<int>& currentPath = chain.path;
+    Random& random = chain.random;
+    if (candidates && candidates->count() > 0)
+    {
+        // Ход, после которого город a и его кандидат c становятся соседями в маршруте
+        int a = random.below(currentPath.size());
+        int c = candidates->get(a, random.below(candidates->count()));
+        int x = chain.position[a];
+        int y = chain.position[c];
+        if (x < y)
+            return { x + 1, y };
+        return { y + 1, x };
+    }
 
-    int i = dist(g);
-    int j = dist(g);
+    int i = random.between(1, currentPath.size() - 1);
+    int j = random.between(1, currentPath.size() - 1);
     if (i > j) 
         std::swap(i, j);
-    std::reverse(newPath.begin() + i, newPath.begin() + j + 1); //  
 
-    return newPath;
+    return { i, j };
+}
+
+// Изменение длины маршрута при инверсии path[i..j].
+// Меняются только два ребра (a, b) и (c, d), поэтому оценка выполняется за O(1)
+// (матрица расстояний предполагается симметричной)
+double SimulatedAnnealing::getMoveDelta(const std::vector<int>& path, const Move& move) const
+{
+    int a = path[move.i - 1];
+    int b = path[move.i];
+    int c = path[move.j];
+    int d = path[(move.j + 1) % path.size()];
+    if (a == d) // Инвертируется весь маршрут, кроме одного города, длина не меняется
+        return 0.0;
+    return distances(a, c) + distances(b, d) - distances(a, b) - distances(c, d);
+}
+
+// Применение хода на месте
+void SimulatedAnnealing::applyMove(Chain& chain, const Move& move)
+{
+    std::reverse(chain.path.begin() + move.i, chain.path.begin() + move.j + 1); // Инверсируем подпоследовательность
+    if (candidates)
+    {
+        for (int k = move.i; k <= move.j; ++k)
+            chain.position[chain.path[k]] = k;
+    }
+}
+
+// Ход, после которого город a и его кандидат c становятся соседями: тот же ход, что
+// в getNeighbor со списками кандидатов, заданный ребрами вместо позиций
+SimulatedAnnealing::ListMove SimulatedAnnealing::getListNeighbor(Chain& chain) const
+{
+    Random& random = chain.random;
+    int a = random.below(chain.listTour.size());
+    int c = candidates->get(a, random.below(candidates->count()));
+    return { a, chain.listTour.next(a), c, chain.listTour.next(c) };
+}
+
+double SimulatedAnnealing::getListMoveDelta(const ListMove& move) const
+{
+    if (move.c == move.b || move.d == move.a) // Города уже соседи, маршрут не меняется
+        return 0.0;
+    return distances(move.a, move.c) + distances(move.b, move.d) - distances(move.a, move.b) - distances(move.c, move.d);
+}
+
+// Пока лучшее решение хранится в журнале, ход записывается в него; слишком длинный
+// журнал сбрасывается копированием лучшего решения, поэтому на ход приходится O(sqrt(N))
+void SimulatedAnnealing::applyListMove(Chain& chain, const ListMove& move)
+{
+    if (move.c == move.b || move.d == move.a)
+        return;
+    chain.listTour.twoOptMove(move.a, move.b, move.c, move.d);
+    if (!chain.bestInJournal)
+        return;
+    chain.sinceBest.push_back(move);
+    if (chain.sinceBest.size() * chain.sinceBest.size() > static_cast<std::size_t>(chain.listTour.size()))
+        saveBest(chain);
+}
+
+// Копирование лучшего решения из журнала: ходы отменяются в обратном порядке, маршрут
+// копируется, затем ходы повторяются
+void SimulatedAnnealing::saveBest(Chain& chain) const
+{
+    TwoLevelTour& tour = chain.listTour;
+    for (auto it = chain.sinceBest.rbegin(); it != chain.sinceBest.rend(); ++it)
+        tour.twoOptMove(it->a, it->c, it->b, it->d);
+    chain.best = tour.cities();
+    for (const ListMove& move : chain.sinceBest)
+        tour.twoOptMove(move.a, move.b, move.c, move.d);
+    chain.sinceBest.clear();
+    chain.bestInJournal = false;
 }
 
-//       
+// Получение вероятности перехода к новому решению 
 double SimulatedAnnealing::getAcceptanceProbability(double currentDistance, double newDistance, double temperature) 
 {
     if (newDistance < currentDistance)
@@ -56,43 +232,296 @@ double SimulatedAnnealing::getAcceptanceProbability(double currentDistance, doub
     return std::exp((currentDistance - newDistance) / temperature);
 }
 
-//  
+// Одна итерация цепочки при температуре temperature
+void SimulatedAnnealing::annealStep(Chain& chain, double temperature, long long iteration)
+{
+    // Генерация соседнего решения
+    Move move = {};
+    ListMove listMove = {};
+    double delta;
+    if (chain.onList)
+    {
+        listMove = getListNeighbor(chain);
+        delta = getListMoveDelta(listMove);
+    }
+    else
+    {
+        move = getNeighbor(chain);
+        delta = getMoveDelta(chain.path, move);
+    }
+    ++chain.evaluations;
+    double newDistance = chain.distance + delta;
+
+    // С определенной вероятностью переход к новому решению
+    if (getAcceptanceProbability(chain.distance, newDistance, temperature) > chain.random.uniform()) 
+    {
+        // Лучшее решение копируется только в момент ухода из него (для listTour - позже, из журнала)
+        if (chain.currentIsBest && newDistance >= chain.bestDistance)
+        {
+            if (chain.onList)
+                chain.bestInJournal = true;
+            else
+                chain.best = chain.path;
+            chain.currentIsBest = false;
+        }
+
+        if (chain.onList)
+            applyListMove(chain, listMove);
+        else
+            applyMove(chain, move);
+        chain.distance = newDistance;
+        ++chain.accepted;
+
+        if (newDistance < chain.bestDistance) 
+        {
+            chain.bestDistance = newDistance;
+            chain.currentIsBest = true;
+            chain.bestInJournal = false;
+            chain.sinceBest.clear();
+            chain.lastImprovement = iteration;
+        }
+    }
+}
+
+// Лучшее решение цепочки (копируется из текущего, если совпадает с ним)
+const std::vector<int>& SimulatedAnnealing::bestPath(Chain& chain) const
+{
+    if (chain.currentIsBest)
+        chain.best = chain.onList ? chain.listTour.cities() : chain.path;
+    else if (chain.bestInJournal)
+        saveBest(chain);
+    return chain.best;
+}
+
+// Обмен с другими солверами портфеля: лучшее решение цепочки публикуется, а более короткий
+// общий маршрут становится ее текущим состоянием
+void SimulatedAnnealing::shareBest(Chain& chain, long long iteration)
+{
+    if (chain.bestDistance < exchange->bestLength())
+    {
+        exchange->publish(bestPath(chain), chain.bestDistance);
+        return;
+    }
+    double length = chain.bestDistance;
+    if (importExchange && exchange->fetchIfShorter(chain.path, length))
+    {
+        loadPath(chain);
+        chain.lastImprovement = iteration;
+    }
+}
+
+// Запуск алгоритма
 std::vector<int> SimulatedAnnealing::solve() 
 {
-    std::vector<int> currentSolution = generateInitialSolution(); //   
-    double currentDistance = calculatePathLength(currentSolution);
-    std::vector<int> bestSolution = currentSolution;
-    double bestDistance = currentDistance;
+    return solve(StopPolicy()).tour;
+}
 
-    double temperature = initialTemp;
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
+// Запуск с условиями остановки; условия проверяются раз в 256 итераций
+// (в параллельном отжиге - перед каждым обменом)
+SolveResult SimulatedAnnealing::solve(const StopPolicy& policy)
+{
+    checkInitialTours(distances.size());
+    StopCondition stop(policy);
+    if (numReplicas > 1 && distances.size() >= 4)
+        return solveReplicas(stop);
 
-    for (int iter = 0; iter != iterations; ++iter) 
+    SolveResult result;
+    evaluations = 0;
+    double phaseSeconds[kSolverPhaseCount] = {};
+    PhaseTimer timer(observer != nullptr);
+    if (observer)
+        observer->onStart("SA", distances.size());
+    if (chains.empty())
+        chains.resize(1);
+    Chain& chain = chains[0];
+    chain.random.reseed(seed);
+    initializeChain(chain); // Генерация начального решения
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+    if (chain.path.size() < 4) // Для трех и менее городов все маршруты одинаковы
     {
-        std::vector<int> newSolution = getNeighbor(currentSolution); //   
-        double newDistance = calculatePathLength(newSolution);
+        if (observer)
+            observer->onFinish({ "SA", 0, chain.distance, chain.distance, -1.0, -1.0, evaluations, phaseSeconds });
+        result.tour = chain.path;
+        result.length = chain.distance;
+        result.reason = StopReason::IterationLimit;
+        result.seconds = stop.elapsedSeconds();
+        return result;
+    }
 
-        //       
-        if (getAcceptanceProbability(currentDistance, newDistance, temperature) > dist(g)) 
-        {
-            currentSolution = newSolution;
-            currentDistance = newDistance;
+    double temperature = initialTemp;
+    int lastReport = 0;
 
-            if (newDistance < bestDistance) 
+    result.reason = StopReason::IterationLimit;
+    int iter = 0;
+    for (; iter != iterations; ++iter) 
+    {
+        if ((iter & 255) == 0)
+        {
+            if (exchange && (iter & kExchangeMask) == 0)
+                shareBest(chain, iter);
+            StopReason reason = stop.check(chain.bestDistance, chain.evaluations, iter - chain.lastImprovement);
+            if (reason != StopReason::None)
             {
-                bestSolution = newSolution;
-                bestDistance = newDistance;
+                result.reason = reason;
+                break;
             }
         }
+
+        annealStep(chain, temperature, iter);
         
-        if (iter % 1000 == 0)
-            std::cout << " " << iter << "  : " << bestDistance << std::endl;
+        if (observer && iter % 1000 == 0)
+        {
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Annealing)]);
+            double acceptanceRate = static_cast<double>(chain.accepted) / (iter - lastReport + 1);
+            observer->onProgress({ "SA", iter, chain.bestDistance, chain.distance, acceptanceRate, -1.0,
+                                   chain.evaluations, phaseSeconds });
+            chain.accepted = 0;
+            lastReport = iter + 1;
+        }
 
-        //   
+        // Уменьшение температуры 
         temperature *= coolingRate;
     }
 
-    return bestSolution;
+    evaluations = chain.evaluations;
+    if (observer)
+    {
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Annealing)]);
+        double acceptanceRate = iter > lastReport ? static_cast<double>(chain.accepted) / (iter - lastReport) : -1.0;
+        observer->onFinish({ "SA", iter, chain.bestDistance, chain.distance, acceptanceRate, -1.0, evaluations, phaseSeconds });
+    }
+    result.tour = bestPath(chain);
+    result.length = chain.bestDistance;
+    result.iterations = iter;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
+}
+
+// Параллельный отжиг. Цепочка в слоте r работает при температуре temperatures[r]
+// (внутри раунда между обменами температура постоянна)
+// (слот 0 - самый холодный); при обмене цепочки меняются слотами, температуры остаются на месте
+SolveResult SimulatedAnnealing::solveReplicas(const StopCondition& stop)
+{
+    SolveResult result;
+    evaluations = 0;
+    double phaseSeconds[kSolverPhaseCount] = {};
+    PhaseTimer timer(observer != nullptr);
+    if (observer)
+        observer->onStart("SA", distances.size());
+
+    // Геометрическая лестница температур от initialTemp до initialTemp * replicaTemperatureRatio
+    std::vector<double> temperatures(numReplicas);
+    for (int r = 0; r < numReplicas; ++r)
+        temperatures[r] = initialTemp * std::pow(replicaTemperatureRatio, static_cast<double>(r) / (numReplicas - 1));
+
+    Random master(seed);
+    chains.resize(numReplicas);
+    for (int r = 0; r < numReplicas; ++r)
+    {
+        chains[r].random = master.split();
+        initializeChain(chains[r], r);
+    }
+    timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Initialization)]);
+
+    auto bestChain = [&]() {
+        int best = 0;
+        for (int r = 1; r < numReplicas; ++r)
+            if (chains[r].bestDistance < chains[best].bestDistance)
+                best = r;
+        return best;
+    };
+    int best = bestChain();
+    std::vector<int> bestSolution = bestPath(chains[best]);
+    double bestDistance = chains[best].bestDistance;
+    int lastImprovement = 0;
+    long long swapAttempts = 0;
+    long long swapsAccepted = 0;
+
+    result.reason = StopReason::IterationLimit;
+    int iter = 0;
+    int round = 0;
+    while (iter < iterations)
+    {
+        StopReason reason = stop.check(bestDistance, evaluations, iter - lastImprovement);
+        if (reason != StopReason::None)
+        {
+            result.reason = reason;
+            break;
+        }
+
+        const int steps = std::min(swapInterval, iterations - iter);
+        auto runChain = [&](int r) {
+            for (int step = 0; step < steps; ++step)
+                annealStep(chains[r], temperatures[r], iter + step);
+        };
+        if (threadPool)
+            threadPool->run(numReplicas, runChain);
+        else
+            for (int r = 0; r < numReplicas; ++r)
+                runChain(r);
+        iter += steps;
+        const double cooling = std::pow(coolingRate, steps); // Лестница охлаждается целиком
+        for (double& temperature : temperatures)
+            temperature *= cooling;
+
+        evaluations = 0;
+        for (const Chain& chain : chains)
+            evaluations += chain.evaluations;
+        best = bestChain();
+        if (chains[best].bestDistance < bestDistance)
+        {
+            bestDistance = chains[best].bestDistance;
+            bestSolution = bestPath(chains[best]);
+            lastImprovement = iter;
+        }
+
+        // Общий лучший маршрут портфеля подхватывает самая холодная цепочка
+        if (exchange)
+        {
+            if (bestDistance < exchange->bestLength())
+                exchange->publish(bestSolution, bestDistance);
+            shareBest(chains[0], iter);
+            if (chains[0].bestDistance < bestDistance)
+            {
+                bestDistance = chains[0].bestDistance;
+                bestSolution = bestPath(chains[0]);
+                lastImprovement = iter;
+            }
+        }
+
+        // Обмены между соседними температурами: в четных раундах пары (0, 1), (2, 3)..., в нечетных (1, 2), (3, 4)...
+        for (int r = round % 2; r + 1 < numReplicas; r += 2)
+        {
+            double exponent = (1.0 / temperatures[r] - 1.0 / temperatures[r + 1]) * (chains[r].distance - chains[r + 1].distance);
+            ++swapAttempts;
+            if (exponent >= 0.0 || master.uniform() < std::exp(exponent))
+            {
+                std::swap(chains[r], chains[r + 1]);
+                ++swapsAccepted;
+            }
+        }
+        ++round;
+
+        if (observer)
+        {
+            timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Annealing)]);
+            // Доля принятых обменов вместо доли принятых ходов
+            double acceptanceRate = static_cast<double>(swapsAccepted) / std::max(1LL, swapAttempts);
+            observer->onProgress({ "SA", iter, bestDistance, chains[0].distance, acceptanceRate, -1.0, evaluations, phaseSeconds });
+        }
+    }
+
+    if (observer)
+    {
+        timer.lap(phaseSeconds[static_cast<int>(SolverPhase::Annealing)]);
+        double acceptanceRate = swapAttempts > 0 ? static_cast<double>(swapsAccepted) / swapAttempts : -1.0;
+        observer->onFinish({ "SA", iter, bestDistance, chains[0].distance, acceptanceRate, -1.0, evaluations, phaseSeconds });
+    }
+    result.tour = std::move(bestSolution);
+    result.length = bestDistance;
+    result.iterations = iter;
+    result.evaluations = evaluations;
+    result.seconds = stop.elapsedSeconds();
+    return result;
 }
@@ -0,0 +1,104 @@
+﻿#include "SolverObserver.h"
+
+#include <iostream>
+#include <limits>
+#include <cstring>
+
+const char* solverPhaseName(SolverPhase phase)
+{
+    switch (phase)
+    {
+    case SolverPhase::Initialization: return "initialization";
+    case SolverPhase::Selection: return "selection";
+    case SolverPhase::Crossover: return "crossover";
+    case SolverPhase::Mutation: return "mutation";
+    case SolverPhase::Evaluation: return "evaluation";
+    case SolverPhase::Construction: return "construction";
+    case SolverPhase::PheromoneUpdate: return "pheromone_update";
+    case SolverPhase::Annealing: return "annealing";
+    case SolverPhase::LocalSearch: return "local_search";
+    case SolverPhase::Decomposition: return "decomposition";
+    default: return "unknown";
+    }
+}
+
+ConsoleObserver::ConsoleObserver(std::ostream& output): output(output) {}
+
+ConsoleObserver::ConsoleObserver(): output(std::cout) {}
+
+void ConsoleObserver::onProgress(const SolverProgress& progress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const char* label = std::strcmp(progress.solver, "GA") == 0 ? "Поколение " : "Итерация ";
+    output << label << progress.iteration << " Лучший путь: " << progress.bestLength << "\n";
+}
+
+void ConsoleObserver::onFinish(const SolverProgress& progress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    output << progress.solver << ": " << progress.evaluations << " оценок, лучший путь " << progress.bestLength;
+    for (int phase = 0; phase < kSolverPhaseCount; ++phase)
+    {
+        if (progress.phaseSeconds[phase] > 0.0)
+            output << ", " << solverPhaseName(static_cast<SolverPhase>(phase)) << " " << progress.phaseSeconds[phase] << " с";
+    }
+    output << std::endl;
+}
+
+SolverCounters::SolverCounters():
+    starts(0),
+    iterations(0),
+    evaluations(0),
+    improvements(0),
+    bestLength(std::numeric_limits<double>::infinity())
+{
+    for (std::atomic<double>& seconds : phaseSeconds)
+        seconds.store(0.0);
+}
+
+void SolverCounters::onStart(const char* /*solver*/, int /*numCities*/)
+{
+    ++starts;
+}
+
+void SolverCounters::onProgress(const SolverProgress& progress)
+{
+    record(progress);
+}
+
+void SolverCounters::onFinish(const SolverProgress& progress)
+{
+    record(progress);
+}
+
+void SolverCounters::record(const SolverProgress& progress)
+{
+    iterations.store(progress.iteration, std::memory_order_relaxed);
+    evaluations.store(progress.evaluations, std::memory_order_relaxed);
+    // Отчеты могут приходить из нескольких потоков: длина только уменьшается, и каждое
+    // улучшение засчитывается одному писателю
+    double seen = bestLength.load(std::memory_order_relaxed);
+    while (progress.bestLength < seen)
+    {
+        if (bestLength.compare_exchange_weak(seen, progress.bestLength, std::memory_order_relaxed))
+        {
+            improvements.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+    for (int phase = 0; phase < kSolverPhaseCount; ++phase)
+        phaseSeconds[phase].store(progress.phaseSeconds[phase], std::memory_order_relaxed);
+}
+
+SolverCounters::Snapshot SolverCounters::snapshot() const
+{
+    Snapshot result;
+    result.starts = starts.load(std::memory_order_relaxed);
+    result.iterations = iterations.load(std::memory_order_relaxed);
+    result.evaluations = evaluations.load(std::memory_order_relaxed);
+    result.improvements = improvements.load(std::memory_order_relaxed);
+    result.bestLength = bestLength.load(std::memory_order_relaxed);
+    for (int phase = 0; phase < kSolverPhaseCount; ++phase)
+        result.phaseSeconds[phase] = phaseSeconds[phase].load(std::memory_order_relaxed);
+    return result;
+}
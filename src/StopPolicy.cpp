@@ -0,0 +1,52 @@
+﻿#include "StopPolicy.h"
+
+const char* stopReasonName(StopReason reason)
+{
+    switch (reason)
+    {
+    case StopReason::None: return "none";
+    case StopReason::IterationLimit: return "iteration_limit";
+    case StopReason::Deadline: return "deadline";
+    case StopReason::TargetReached: return "target_reached";
+    case StopReason::EvaluationLimit: return "evaluation_limit";
+    case StopReason::Stalled: return "stalled";
+    case StopReason::Cancelled: return "cancelled";
+    default: return "unknown";
+    }
+}
+
+StopCondition::StopCondition(const StopPolicy& policy):
+    policy(policy),
+    start(std::chrono::steady_clock::now()),
+    deadline(policy.deadline)
+{
+    if (policy.timeLimit > std::chrono::steady_clock::duration::zero() && policy.timeLimit < deadline - start)
+        deadline = start + policy.timeLimit;
+    hasDeadline = deadline != std::chrono::steady_clock::time_point::max();
+}
+
+// Часы опрашиваются, только если срок задан
+StopReason StopCondition::interrupted() const
+{
+    if (policy.cancellation && policy.cancellation->isCancelled())
+        return StopReason::Cancelled;
+    if (hasDeadline && std::chrono::steady_clock::now() >= deadline)
+        return StopReason::Deadline;
+    return StopReason::None;
+}
+
+StopReason StopCondition::check(double bestLength, long long evaluations, int stalledIterations) const
+{
+    if (bestLength <= policy.targetLength)
+        return StopReason::TargetReached;
+    if (policy.maxEvaluations > 0 && evaluations >= policy.maxEvaluations)
+        return StopReason::EvaluationLimit;
+    if (stalled(stalledIterations))
+        return StopReason::Stalled;
+    return interrupted();
+}
+
+double StopCondition::elapsedSeconds() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,95 @@
+﻿#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int numThreads)
+{
+    for (int i = 1; i < numThreads; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+// Разбор задач текущего вызова run до их исчерпания
+void ThreadPool::execute()
+{
+    for (int task = nextTask.fetch_add(1); task < taskCount; task = nextTask.fetch_add(1))
+    {
+        try
+        {
+            (*currentTask)(task);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned long long seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            ++activeWorkers;
+        }
+        execute();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+        }
+        finished.notify_all();
+    }
+}
+
+void ThreadPool::run(int count, const std::function<void(int)>& task)
+{
+    if (count <= 0)
+        return;
+    if (workers.empty() || count == 1)
+    {
+        for (int i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // Рабочий, проснувшийся после завершения предыдущего run, должен выйти из execute
+        finished.wait(lock, [&] { return activeWorkers == 0; });
+        currentTask = &task;
+        taskCount = count;
+        nextTask.store(0);
+        error = nullptr;
+        ++generation;
+    }
+    wakeUp.notify_all();
+
+    execute();
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return activeWorkers == 0; });
+        currentTask = nullptr;
+        failure = error;
+    }
+    if (failure)
+        std::rethrow_exception(failure);
+}
@@ -0,0 +1,445 @@
+﻿#include "TourConstruction.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+namespace {
+
+// Система непересекающихся множеств для проверки, не замкнет ли ребро цикл
+class DisjointSets {
+public:
+    explicit DisjointSets(int size): parent(size)
+    {
+        for (int i = 0; i < size; ++i)
+            parent[i] = i;
+    }
+
+    int find(int a)
+    {
+        while (parent[a] != a)
+        {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    }
+
+    bool unite(int a, int b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+            return false;
+        parent[a] = b;
+        return true;
+    }
+
+private:
+    std::vector<int> parent;
+};
+
+// Номер клетки сетки 2^16 x 2^16 на кривой Гильберта
+std::uint64_t hilbertIndex(std::uint32_t x, std::uint32_t y)
+{
+    const std::uint32_t side = 1u << 16;
+    std::uint64_t index = 0;
+    for (std::uint32_t s = side / 2; s > 0; s /= 2)
+    {
+        std::uint32_t rx = (x & s) > 0;
+        std::uint32_t ry = (y & s) > 0;
+        index += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+// Переход по пути, заданному соседями adj[2 * city] и adj[2 * city + 1] (-1 - нет соседа)
+int nextOnPath(const std::vector<int>& adj, int city, int previous)
+{
+    int a = adj[2 * city];
+    int b = adj[2 * city + 1];
+    if (a != -1 && a != previous)
+        return a;
+    if (b != -1 && b != previous)
+        return b;
+    return -1;
+}
+
+void link(std::vector<int>& adj, std::vector<int>& degree, int a, int b)
+{
+    adj[2 * a + degree[a]++] = b;
+    adj[2 * b + degree[b]++] = a;
+}
+
+} // namespace
+
+// Изменяемое множество городов с поиском ближайшего к заданному городу:
+// kd-дерево для задач с координатами, перебор для задач с матрицей
+class TourConstruction::NearestSet {
+public:
+    NearestSet(const TourConstruction& owner, bool all): owner(owner)
+    {
+        const int size = owner.distances.size();
+        if (owner.tree)
+        {
+            owner.tree->fillSubset(subset, all);
+            return;
+        }
+        where.assign(size, -1);
+        if (all)
+        {
+            for (int city = 0; city < size; ++city)
+            {
+                where[city] = city;
+                cities.push_back(city);
+            }
+        }
+    }
+
+    void insert(int city)
+    {
+        if (owner.tree)
+        {
+            owner.tree->insert(subset, city);
+        }
+        else if (where[city] < 0)
+        {
+            where[city] = static_cast<int>(cities.size());
+            cities.push_back(city);
+        }
+    }
+
+    void erase(int city)
+    {
+        if (owner.tree)
+        {
+            owner.tree->erase(subset, city);
+        }
+        else if (where[city] >= 0)
+        {
+            int last = cities.back();
+            cities[where[city]] = last;
+            where[last] = where[city];
+            cities.pop_back();
+            where[city] = -1;
+        }
+    }
+
+    // Ближайший к city город множества или -1, если оно пусто
+    int nearest(int city) const
+    {
+        if (owner.tree)
+            return owner.tree->nearestIn(subset, owner.x[city], owner.y[city]);
+        int best = -1;
+        double bestDistance = 0.0;
+        for (int other : cities)
+        {
+            double distance = owner.distances(city, other);
+            if (best < 0 || distance < bestDistance)
+            {
+                best = other;
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+
+private:
+    const TourConstruction& owner;
+    KdTree::Subset subset;
+    std::vector<int> cities; // Для матрицы: города множества и позиция каждого из них
+    std::vector<int> where;
+};
+
+TourConstruction::TourConstruction(const TspInstance& distances, std::shared_ptr<const CandidateLists> candidates,
+                                   ConstructionMethod method):
+    distances(distances),
+    candidates(std::move(candidates)),
+    constructionMethod(method),
+    noise(1)
+{
+    const int numCities = distances.size();
+    if (method == ConstructionMethod::SpaceFillingCurve && !distances.hasCoordinates())
+        throw std::invalid_argument("TourConstruction: кривая Гильберта требует координат городов");
+    if (this->candidates && this->candidates->size() != numCities)
+        throw std::invalid_argument("TourConstruction: списки кандидатов построены для другой задачи");
+    if (!this->candidates && method != ConstructionMethod::Random && method != ConstructionMethod::SpaceFillingCurve)
+        this->candidates = std::make_shared<CandidateLists>(distances, 10);
+
+    if (distances.hasCoordinates())
+    {
+        const CoordinateDistances& coordinates = *distances.coordinates();
+        x.resize(numCities);
+        y.resize(numCities);
+        for (int i = 0; i < numCities; ++i)
+        {
+            x[i] = coordinates.getX(i);
+            y[i] = coordinates.getY(i);
+        }
+        if (method != ConstructionMethod::Random && method != ConstructionMethod::SpaceFillingCurve)
+            tree.reset(new KdTree(x, y));
+    }
+}
+
+void TourConstruction::setNoise(int newNoise)
+{
+    noise = std::max(1, newNoise);
+}
+
+void TourConstruction::build(std::vector<int>& tour, Random& random) const
+{
+    const int numCities = distances.size();
+    if (numCities < 4 || constructionMethod == ConstructionMethod::Random)
+    {
+        tour.resize(numCities);
+        for (int i = 0; i < numCities; ++i)
+            tour[i] = i;
+        if (constructionMethod == ConstructionMethod::Random)
+            std::shuffle(tour.begin(), tour.end(), random);
+        return;
+    }
+
+    switch (constructionMethod)
+    {
+    case ConstructionMethod::NearestNeighbor:
+        nearestNeighbor(tour, random);
+        break;
+    case ConstructionMethod::Greedy:
+        greedy(tour);
+        break;
+    case ConstructionMethod::SpaceFillingCurve:
+        spaceFillingCurve(tour);
+        break;
+    case ConstructionMethod::SpanningTree:
+        spanningTree(tour, random);
+        break;
+    default:
+        break;
+    }
+}
+
+// Ближайший сосед: следующий город выбирается среди noise ближайших непосещенных кандидатов,
+// а если все кандидаты уже посещены - ближайший непосещенный город вообще
+void TourConstruction::nearestNeighbor(std::vector<int>& tour, Random& random) const
+{
+    const int numCities = distances.size();
+    std::vector<char> visited(numCities, 0);
+    std::vector<int> choices;
+    choices.reserve(noise);
+    NearestSet unvisited(*this, true);
+
+    tour.clear();
+    tour.reserve(numCities);
+    int current = random.below(numCities);
+    while (true)
+    {
+        tour.push_back(current);
+        visited[current] = 1;
+        unvisited.erase(current);
+        if (static_cast<int>(tour.size()) == numCities)
+            break;
+
+        choices.clear();
+        for (const int* c = candidates->begin(current); c != candidates->end(current); ++c)
+        {
+            if (visited[*c])
+                continue;
+            choices.push_back(*c);
+            if (static_cast<int>(choices.size()) == noise)
+                break;
+        }
+        if (choices.empty())
+            current = unvisited.nearest(current);
+        else
+            current = choices.size() == 1 ? choices[0] : choices[random.below(static_cast<int>(choices.size()))];
+    }
+}
+
+// Ребра из списков кандидатов (каждое по одному разу) в порядке возрастания длины
+std::vector<TourConstruction::Edge> TourConstruction::candidateEdges() const
+{
+    const int numCities = distances.size();
+    std::vector<Edge> edges;
+    edges.reserve(static_cast<std::size_t>(numCities) * candidates->count());
+    for (int a = 0; a < numCities; ++a)
+    {
+        for (const int* c = candidates->begin(a); c != candidates->end(a); ++c)
+        {
+            int b = *c;
+            // Ребро, которое есть в обоих списках, добавляет город с меньшим номером
+            if (b < a && std::find(candidates->begin(b), candidates->end(b), a) != candidates->end(b))
+                continue;
+            edges.push_back({ distances(a, b), std::min(a, b), std::max(a, b) });
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& e1, const Edge& e2) {
+        if (e1.length != e2.length)
+            return e1.length < e2.length;
+        return e1.from != e2.from ? e1.from < e2.from : e1.to < e2.to;
+    });
+    return edges;
+}
+
+// Жадный метод: ребра добавляются по возрастанию длины, если не создают города степени 3
+// и преждевременного цикла. Оставшиеся фрагменты соединяются ближайшим соседом по их концам
+void TourConstruction::greedy(std::vector<int>& tour) const
+{
+    const int numCities = distances.size();
+    std::vector<int> adj(2 * static_cast<std::size_t>(numCities), -1);
+    std::vector<int> degree(numCities, 0);
+    DisjointSets fragments(numCities);
+    for (const Edge& edge : candidateEdges())
+        if (degree[edge.from] < 2 && degree[edge.to] < 2 && fragments.unite(edge.from, edge.to))
+            link(adj, degree, edge.from, edge.to);
+
+    NearestSet ends(*this, false);
+    for (int city = 0; city < numCities; ++city)
+        if (degree[city] < 2)
+            ends.insert(city);
+
+    int start = static_cast<int>(std::find_if(degree.begin(), degree.end(), [](int d) { return d < 2; }) - degree.begin());
+    int current = start;
+    int previous = -1;
+    while (true)
+    {
+        // Проход по фрагменту до его второго конца
+        ends.erase(current);
+        for (int next = nextOnPath(adj, current, previous); next != -1; next = nextOnPath(adj, current, previous))
+        {
+            previous = current;
+            current = next;
+        }
+        ends.erase(current);
+        int next = ends.nearest(current);
+        if (next < 0)
+            break;
+        link(adj, degree, current, next);
+        previous = current;
+        current = next;
+    }
+
+    tour.clear();
+    tour.reserve(numCities);
+    previous = -1;
+    for (int city = start; city != -1; )
+    {
+        tour.push_back(city);
+        int next = nextOnPath(adj, city, previous);
+        previous = city;
+        city = next;
+    }
+}
+
+// Порядок городов вдоль кривой Гильберта, наложенной на ограничивающий квадрат
+void TourConstruction::spaceFillingCurve(std::vector<int>& tour) const
+{
+    const int numCities = distances.size();
+    double minX = *std::min_element(x.begin(), x.end());
+    double minY = *std::min_element(y.begin(), y.end());
+    double extent = std::max(*std::max_element(x.begin(), x.end()) - minX, *std::max_element(y.begin(), y.end()) - minY);
+    double scale = extent > 0.0 ? 65535.0 / extent : 0.0;
+
+    std::vector<std::pair<std::uint64_t, int>> keys(numCities);
+    for (int i = 0; i < numCities; ++i)
+    {
+        std::uint32_t gx = static_cast<std::uint32_t>((x[i] - minX) * scale);
+        std::uint32_t gy = static_cast<std::uint32_t>((y[i] - minY) * scale);
+        keys[i] = std::make_pair(hilbertIndex(gx, gy), i);
+    }
+    std::sort(keys.begin(), keys.end());
+    tour.resize(numCities);
+    for (int i = 0; i < numCities; ++i)
+        tour[i] = keys[i].second;
+}
+
+// Минимальное остовное дерево (Крускал по ребрам кандидатов; компоненты, если граф кандидатов
+// несвязен, соединяются ближайшими парами городов), затем обход в глубину из случайного
+// города с пропуском посещенных. Длина не больше удвоенной длины дерева
+void TourConstruction::spanningTree(std::vector<int>& tour, Random& random) const
+{
+    const int numCities = distances.size();
+    std::vector<std::pair<int, int>> treeEdges;
+    treeEdges.reserve(numCities - 1);
+    DisjointSets components(numCities);
+    for (const Edge& edge : candidateEdges())
+        if (components.unite(edge.from, edge.to))
+            treeEdges.emplace_back(edge.from, edge.to);
+
+    if (static_cast<int>(treeEdges.size()) < numCities - 1)
+    {
+        std::vector<int> order(numCities);
+        for (int i = 0; i < numCities; ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return components.find(a) < components.find(b); });
+
+        NearestSet joined(*this, false);
+        for (int begin = 0; begin < numCities; )
+        {
+            int root = components.find(order[begin]);
+            int end = begin;
+            while (end < numCities && components.find(order[end]) == root)
+                ++end;
+            if (begin > 0)
+            {
+                int bestFrom = -1;
+                int bestTo = -1;
+                for (int k = begin; k < end; ++k)
+                {
+                    int other = joined.nearest(order[k]);
+                    if (bestFrom < 0 || distances(order[k], other) < distances(bestFrom, bestTo))
+                    {
+                        bestFrom = order[k];
+                        bestTo = other;
+                    }
+                }
+                treeEdges.emplace_back(bestFrom, bestTo);
+            }
+            for (int k = begin; k < end; ++k)
+                joined.insert(order[k]);
+            begin = end;
+        }
+    }
+
+    // Списки смежности дерева одним массивом
+    std::vector<int> offset(numCities + 1, 0);
+    for (const std::pair<int, int>& edge : treeEdges)
+    {
+        ++offset[edge.first + 1];
+        ++offset[edge.second + 1];
+    }
+    for (int i = 0; i < numCities; ++i)
+        offset[i + 1] += offset[i];
+    std::vector<int> neighbors(offset[numCities]);
+    std::vector<int> fill(offset.begin(), offset.end() - 1);
+    for (const std::pair<int, int>& edge : treeEdges)
+    {
+        neighbors[fill[edge.first]++] = edge.second;
+        neighbors[fill[edge.second]++] = edge.first;
+    }
+
+    std::vector<char> visited(numCities, 0);
+    std::vector<int> stack(1, random.below(numCities));
+    tour.clear();
+    tour.reserve(numCities);
+    while (!stack.empty())
+    {
+        int city = stack.back();
+        stack.pop_back();
+        if (visited[city])
+            continue;
+        visited[city] = 1;
+        tour.push_back(city);
+        for (int k = offset[city + 1] - 1; k >= offset[city]; --k)
+            if (!visited[neighbors[k]])
+                stack.push_back(neighbors[k]);
+    }
+}
@@ -0,0 +1,42 @@
+﻿#include "TourExchange.h"
+#include <limits>
+
+namespace
+{
+    // Относительный порог: длины, посчитанные разными солверами, могут расходиться в последних
+    // знаках, и без порога один и тот же маршрут передавался бы туда и обратно
+    const double kRelativeTolerance = 1e-9;
+}
+
+TourExchange::TourExchange():
+    length(std::numeric_limits<double>::infinity()) {}
+
+bool TourExchange::publish(const std::vector<int>& tour, double tourLength)
+{
+    if (tourLength >= bestLength())
+        return false;
+    std::shared_ptr<const Snapshot> candidate = std::make_shared<Snapshot>(Snapshot{ tour, tourLength });
+    std::shared_ptr<const Snapshot> current = std::atomic_load(&snapshot);
+    do
+    {
+        if (current && current->length <= tourLength)
+            return false;
+    } while (!std::atomic_compare_exchange_weak(&snapshot, &current, candidate));
+
+    // Длина только уменьшается, даже если два писателя обновляют ее в обратном порядке
+    double seen = length.load(std::memory_order_relaxed);
+    while (tourLength < seen && !length.compare_exchange_weak(seen, tourLength, std::memory_order_release));
+    return true;
+}
+
+bool TourExchange::fetchIfShorter(std::vector<int>& tour, double& tourLength) const
+{
+    if (bestLength() >= tourLength * (1.0 - kRelativeTolerance))
+        return false;
+    std::shared_ptr<const Snapshot> current = std::atomic_load(&snapshot);
+    if (!current || current->length >= tourLength * (1.0 - kRelativeTolerance))
+        return false;
+    tour = current->tour;
+    tourLength = current->length;
+    return true;
+}
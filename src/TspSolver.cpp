@@ -0,0 +1,19 @@
+﻿#include "TspSolver.h"
+#include <stdexcept>
+
+void TspSolver::checkInitialTours(int numCities) const
+{
+    std::vector<char> seen;
+    for (const std::vector<int>& tour : initialTours)
+    {
+        if (static_cast<int>(tour.size()) != numCities)
+            throw std::invalid_argument("TspSolver: длина начального маршрута не совпадает с числом городов");
+        seen.assign(numCities, 0);
+        for (int city : tour)
+        {
+            if (city < 0 || city >= numCities || seen[city])
+                throw std::invalid_argument("TspSolver: начальный маршрут не является перестановкой городов");
+            seen[city] = 1;
+        }
+    }
+}
@@ -0,0 +1,204 @@
+﻿#include "TsplibReader.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string trim(const std::string& s)
+{
+    std::size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return "";
+    std::size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string toUpper(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return s;
+}
+
+void fail(const std::string& message)
+{
+    throw std::runtime_error("TSPLIB: " + message);
+}
+
+int parseDimension(const std::string& value)
+{
+    try
+    {
+        std::size_t end = 0;
+        int dimension = std::stoi(value, &end);
+        if (end == value.size())
+            return dimension;
+    }
+    catch (const std::logic_error&) // invalid_argument и out_of_range
+    {
+    }
+    fail("неверный DIMENSION " + value);
+    return 0;
+}
+
+DistanceMetric parseMetric(const std::string& type)
+{
+    if (type == "EUC_2D")
+        return DistanceMetric::Euc2D;
+    if (type == "CEIL_2D")
+        return DistanceMetric::Ceil2D;
+    if (type == "GEO")
+        return DistanceMetric::Geo;
+    if (type == "ATT")
+        return DistanceMetric::Att;
+    fail("неподдерживаемый EDGE_WEIGHT_TYPE " + type);
+    return DistanceMetric::Euclidean;
+}
+
+double readNumber(std::istream& input)
+{
+    double value;
+    if (!(input >> value))
+        fail("неожиданный конец данных");
+    return value;
+}
+
+// Чтение явной матрицы весов в одном из форматов EDGE_WEIGHT_FORMAT
+std::shared_ptr<DistanceMatrix> readWeights(std::istream& input, int n, const std::string& format)
+{
+    if (format == "FULL_MATRIX")
+    {
+        auto matrix = std::make_shared<DistanceMatrix>(n);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                matrix->set(i, j, readNumber(input));
+        return matrix;
+    }
+
+    // Симметричные форматы хранятся упакованным верхним треугольником.
+    // Столбцовые форматы для симметричной матрицы совпадают с построчными "зеркальными"
+    bool upper = format == "UPPER_ROW" || format == "UPPER_DIAG_ROW" || format == "LOWER_COL" || format == "LOWER_DIAG_COL";
+    bool lower = format == "LOWER_ROW" || format == "LOWER_DIAG_ROW" || format == "UPPER_COL" || format == "UPPER_DIAG_COL";
+    if (!upper && !lower)
+        fail("неподдерживаемый EDGE_WEIGHT_FORMAT " + format);
+    bool diagonal = format.find("DIAG") != std::string::npos;
+
+    auto matrix = std::make_shared<DistanceMatrix>(n, DistanceMatrix::Precision::Double, DistanceMatrix::Layout::UpperTriangular);
+    for (int i = 0; i < n; ++i)
+    {
+        int from = upper ? (diagonal ? i : i + 1) : 0;
+        int to = upper ? n : (diagonal ? i + 1 : i);
+        for (int j = from; j < to; ++j)
+            matrix->set(i, j, readNumber(input));
+    }
+    return matrix;
+}
+
+}
+
+TsplibProblem readTsplib(std::istream& input, int cacheSlotsPerRow)
+{
+    std::string name;
+    std::string comment;
+    std::string edgeWeightType;
+    std::string edgeWeightFormat = "FULL_MATRIX";
+    int dimension = -1;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::shared_ptr<DistanceMatrix> weights;
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        line = trim(line);
+        if (line.empty())
+            continue;
+
+        std::string key;
+        std::string value;
+        std::size_t colon = line.find(':');
+        if (colon != std::string::npos)
+        {
+            key = toUpper(trim(line.substr(0, colon)));
+            value = trim(line.substr(colon + 1));
+        }
+        else
+        {
+            key = toUpper(line);
+        }
+
+        if (key == "EOF")
+            break;
+        else if (key == "NAME")
+            name = value;
+        else if (key == "COMMENT")
+            comment += comment.empty() ? value : "\n" + value;
+        else if (key == "TYPE")
+        {
+            std::string type = toUpper(value);
+            if (type == "ATSP") // Все солверы рассчитаны на симметричные расстояния
+                fail("несимметричные задачи (TYPE: ATSP) не поддерживаются");
+            if (type != "TSP")
+                fail("неподдерживаемый TYPE " + value);
+        }
+        else if (key == "DIMENSION")
+            dimension = parseDimension(value);
+        else if (key == "EDGE_WEIGHT_TYPE")
+            edgeWeightType = toUpper(value);
+        else if (key == "EDGE_WEIGHT_FORMAT")
+            edgeWeightFormat = toUpper(value);
+        else if (key == "NODE_COORD_SECTION")
+        {
+            if (dimension <= 0)
+                fail("NODE_COORD_SECTION до DIMENSION");
+            x.assign(dimension, 0.0);
+            y.assign(dimension, 0.0);
+            for (int k = 0; k < dimension; ++k)
+            {
+                int id = static_cast<int>(readNumber(input));
+                if (id < 1 || id > dimension)
+                    fail("неверный номер вершины в NODE_COORD_SECTION");
+                x[id - 1] = readNumber(input);
+                y[id - 1] = readNumber(input);
+            }
+        }
+        else if (key == "EDGE_WEIGHT_SECTION")
+        {
+            if (dimension <= 0)
+                fail("EDGE_WEIGHT_SECTION до DIMENSION");
+            weights = readWeights(input, dimension, edgeWeightFormat);
+        }
+        else if (key == "DISPLAY_DATA_SECTION")
+        {
+            for (int k = 0; k < dimension * 3; ++k)
+                readNumber(input);
+        }
+        // Остальные ключевые слова (NODE_COORD_TYPE, DISPLAY_DATA_TYPE и т.п.) пропускаются
+    }
+
+    if (dimension <= 0)
+        fail("не задан DIMENSION");
+
+    if (edgeWeightType == "EXPLICIT")
+    {
+        if (!weights)
+            fail("нет EDGE_WEIGHT_SECTION");
+        return { name, comment, TspInstance(weights) };
+    }
+    if (x.empty())
+        fail("нет NODE_COORD_SECTION");
+    auto coordinates = std::make_shared<CoordinateDistances>(std::move(x), std::move(y),
+                                                             parseMetric(edgeWeightType), cacheSlotsPerRow);
+    return { name, comment, TspInstance(coordinates) };
+}
+
+TsplibProblem readTsplibFile(const std::string& path, int cacheSlotsPerRow)
+{
+    std::ifstream input(path);
+    if (!input)
+        fail("не удалось открыть файл " + path);
+    return readTsplib(input, cacheSlotsPerRow);
+}
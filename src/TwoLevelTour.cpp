@@ -0,0 +1,228 @@
+﻿#include "TwoLevelTour.h"
+#include <algorithm>
+#include <cmath>
+
+void TwoLevelTour::assign(const std::vector<int>& cities)
+{
+    numCities = static_cast<int>(cities.size());
+    groupSize = std::max(8, static_cast<int>(std::sqrt(static_cast<double>(numCities))));
+    segmentCount = (numCities + groupSize - 1) / groupSize;
+    maxSegments = 2 * segmentCount + 8;
+    if (static_cast<int>(segments.size()) < segmentCount)
+        segments.resize(segmentCount);
+    segmentOf.resize(numCities);
+    indexOf.resize(numCities);
+    order.resize(segmentCount);
+    for (int s = 0; s < segmentCount; ++s)
+    {
+        Segment& segment = segments[s];
+        int begin = s * groupSize;
+        int end = std::min(numCities, begin + groupSize);
+        segment.cities.assign(cities.begin() + begin, cities.begin() + end);
+        segment.reversed = false;
+        segment.rank = s;
+        order[s] = s;
+        for (int k = 0; k < end - begin; ++k)
+        {
+            segmentOf[segment.cities[k]] = s;
+            indexOf[segment.cities[k]] = k;
+        }
+    }
+}
+
+std::vector<int> TwoLevelTour::cities() const
+{
+    std::vector<int> result;
+    result.reserve(numCities);
+    for (int s : order)
+    {
+        const Segment& segment = segments[s];
+        if (segment.reversed)
+            result.insert(result.end(), segment.cities.rbegin(), segment.cities.rend());
+        else
+            result.insert(result.end(), segment.cities.begin(), segment.cities.end());
+    }
+    return result;
+}
+
+int TwoLevelTour::cityAt(int index) const
+{
+    return advance(firstCity(order[0]), index);
+}
+
+int TwoLevelTour::offset(int city) const
+{
+    const Segment& segment = segments[segmentOf[city]];
+    return segment.reversed ? static_cast<int>(segment.cities.size()) - 1 - indexOf[city] : indexOf[city];
+}
+
+long long TwoLevelTour::key(int city) const
+{
+    return static_cast<long long>(segments[segmentOf[city]].rank) * numCities + offset(city);
+}
+
+int TwoLevelTour::advance(int city, int steps) const
+{
+    int segment = segmentOf[city];
+    int at = offset(city) + steps;
+    for (;;)
+    {
+        int length = static_cast<int>(segments[segment].cities.size());
+        if (at < length)
+            return cityAtOffset(segment, at);
+        at -= length;
+        int rank = segments[segment].rank + 1;
+        segment = order[rank == static_cast<int>(order.size()) ? 0 : rank];
+    }
+}
+
+bool TwoLevelTour::between(int a, int b, int c) const
+{
+    long long ka = key(a);
+    long long kb = key(b);
+    long long kc = key(c);
+    if (ka <= kc)
+        return ka <= kb && kb <= kc;
+    return kb >= ka || kb <= kc;
+}
+
+void TwoLevelTour::renumber(int fromRank, int toRank)
+{
+    for (int rank = fromRank; rank <= toRank; ++rank)
+        segments[order[rank]].rank = rank;
+}
+
+void TwoLevelTour::split(int segment, int at)
+{
+    int created = segmentCount++;
+    if (created == static_cast<int>(segments.size()))
+        segments.emplace_back();
+    Segment& source = segments[segment];
+    Segment& target = segments[created];
+    int length = static_cast<int>(source.cities.size());
+    if (source.reversed)
+    {
+        // Хвост по направлению обхода лежит в начале массива
+        target.cities.assign(source.cities.begin(), source.cities.begin() + (length - at));
+        source.cities.erase(source.cities.begin(), source.cities.begin() + (length - at));
+        for (int k = 0; k < at; ++k)
+            indexOf[source.cities[k]] = k;
+    }
+    else
+    {
+        target.cities.assign(source.cities.begin() + at, source.cities.end());
+        source.cities.resize(at);
+    }
+    target.reversed = source.reversed;
+    for (int k = 0; k < length - at; ++k)
+    {
+        segmentOf[target.cities[k]] = created;
+        indexOf[target.cities[k]] = k;
+    }
+    order.insert(order.begin() + source.rank + 1, created);
+    renumber(source.rank + 1, static_cast<int>(order.size()) - 1);
+}
+
+void TwoLevelTour::splitBefore(int city)
+{
+    int at = offset(city);
+    if (at > 0)
+        split(segmentOf[city], at);
+}
+
+// Инверсия пути from..to. Короткий путь (в пределах одного или двух соседних сегментов)
+// инвертируется обменом городов, длинный - перестановкой целых сегментов
+void TwoLevelTour::reverse(int from, int to)
+{
+    const Segment& first = segments[segmentOf[from]];
+    const Segment& last = segments[segmentOf[to]];
+    int length = -1;
+    if (&first == &last)
+        length = offset(to) - offset(from) + 1;
+    else if (last.rank == first.rank + 1)
+        length = static_cast<int>(first.cities.size()) - offset(from) + offset(to) + 1;
+    if (length >= 0 && length <= groupSize)
+    {
+        for (int step = length / 2; step > 0; --step)
+        {
+            int following = next(from);
+            int preceding = prev(to);
+            int sf = segmentOf[from];
+            int st = segmentOf[to];
+            std::swap(segments[sf].cities[indexOf[from]], segments[st].cities[indexOf[to]]);
+            std::swap(segmentOf[from], segmentOf[to]);
+            std::swap(indexOf[from], indexOf[to]);
+            from = following;
+            to = preceding;
+        }
+        return;
+    }
+
+    int after = next(to);
+    splitBefore(from);
+    splitBefore(after);
+    int firstRank = segments[segmentOf[from]].rank;
+    int lastRank = segments[segmentOf[to]].rank;
+    std::reverse(order.begin() + firstRank, order.begin() + lastRank + 1);
+    for (int rank = firstRank; rank <= lastRank; ++rank)
+    {
+        Segment& segment = segments[order[rank]];
+        segment.rank = rank;
+        segment.reversed = !segment.reversed;
+    }
+    if (static_cast<int>(order.size()) > maxSegments)
+        rebuild();
+}
+
+// Из двух путей b..c и d..a выбирается тот, что не проходит через начало маршрута
+// (такой есть всегда), а если подходят оба - более короткий
+void TwoLevelTour::twoOptMove(int a, int b, int c, int d)
+{
+    if (next(a) != b)
+    {
+        std::swap(a, b);
+        std::swap(c, d);
+    }
+    long long ka = key(a);
+    long long kb = key(b);
+    long long kc = key(c);
+    long long kd = key(d);
+    bool inner = kb <= kc;
+    bool outer = kd <= ka;
+    if (inner && (!outer || kc - kb <= ka - kd))
+        reverse(b, c);
+    else
+        reverse(d, a);
+}
+
+void TwoLevelTour::swapSegments(int first, int length1, int length2)
+{
+    int second = advance(first, length1);
+    int after = advance(second, length2);
+    splitBefore(first);
+    splitBefore(second);
+    splitBefore(after);
+    // Начало маршрута переносится на first, чтобы оба участка шли подряд без перехода через конец
+    int count = static_cast<int>(order.size());
+    int start = segments[segmentOf[first]].rank;
+    if (start > 0)
+    {
+        std::rotate(order.begin(), order.begin() + start, order.end());
+        renumber(0, count - 1);
+    }
+    int middle = segments[segmentOf[second]].rank;
+    int end = segments[segmentOf[after]].rank;
+    if (end == 0)
+        end = count;
+    std::rotate(order.begin(), order.begin() + middle, order.begin() + end);
+    renumber(0, end - 1);
+    if (count > maxSegments)
+        rebuild();
+}
+
+// Раздробленный на мелкие сегменты список собирается заново
+void TwoLevelTour::rebuild()
+{
+    buffer = cities();
+    assign(buffer);
+}
@@ -0,0 +1,82 @@
+﻿// Преобразование матрицы расстояний в двоичный формат для mapMatrixFile.
+// Использование: matrix_convert INPUT OUTPUT [--type float64|float32|int32] [--full]
+// INPUT - файл TSPLIB (.tsp) или текстовая матрица: N, затем N * N чисел по строкам.
+// По умолчанию значения хранятся в float32, а симметричная матрица - верхним треугольником;
+// --full сохраняет полную матрицу (для несимметричных задач)
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "tsp_solver.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: matrix_convert INPUT OUTPUT [--type float64|float32|int32] [--full]\n";
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+    DistanceMatrix::Precision precision = DistanceMatrix::Precision::Float;
+    DistanceMatrix::Layout layout = DistanceMatrix::Layout::UpperTriangular;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--full")
+        {
+            layout = DistanceMatrix::Layout::Full;
+        }
+        else if (arg == "--type" && i + 1 < argc)
+        {
+            std::string type = argv[++i];
+            if (type == "float64")
+                precision = DistanceMatrix::Precision::Double;
+            else if (type == "float32")
+                precision = DistanceMatrix::Precision::Float;
+            else if (type == "int32")
+                precision = DistanceMatrix::Precision::Int32;
+            else
+            {
+                std::cerr << "unknown type: " << type << "\n";
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    try
+    {
+        if (input.size() > 4 && input.compare(input.size() - 4, 4, ".tsp") == 0)
+        {
+            // TSPLIB: задача целиком в памяти, расстояния по координатам вычисляются при записи
+            TsplibProblem problem = readTsplibFile(input);
+            const TspInstance& instance = problem.instance;
+            DistanceMatrix matrix(instance.size(), precision, layout);
+            for (int i = 0; i < instance.size(); ++i)
+                for (int j = layout == DistanceMatrix::Layout::Full ? 0 : i + 1; j < instance.size(); ++j)
+                    matrix.set(i, j, instance(i, j));
+            writeMatrixFile(output, matrix);
+        }
+        else
+        {
+            std::ifstream stream(input);
+            if (!stream)
+            {
+                std::cerr << "cannot open " << input << "\n";
+                return 1;
+            }
+            convertTextMatrix(stream, output, precision, layout);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}